@@ -7,6 +7,7 @@ namespace ge211 {}
 #include "ge211_color.hxx"
 #include "ge211_error.hxx"
 #include "ge211_event.hxx"
+#include "ge211_frame_timing.hxx"
 #include "ge211_geometry.hxx"
 #include "ge211_audio.hxx"
 #include "ge211_resource.hxx"
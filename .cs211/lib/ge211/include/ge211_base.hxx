@@ -5,6 +5,7 @@
 #include "ge211_error.hxx"
 #include "ge211_event.hxx"
 #include "ge211_forward.hxx"
+#include "ge211_frame_timing.hxx"
 #include "ge211_geometry.hxx"
 #include "ge211_noexcept.hxx"
 #include "ge211_random.hxx"
@@ -133,8 +134,23 @@ public:
 
     /// Runs the game. Usually the way to use this is to create an instance of
     /// your game class in `main` and then call run() on it.
+    ///
+    /// If the environment variable `GE211_OFFSCREEN` is set to a number of
+    /// frames, this runs the game offscreen for that many frames instead,
+    /// as by run_offscreen(long). If it's set to anything else, this warns
+    /// and runs the game on screen.
     void run();
 
+    /// Runs the game for at most `frames` frames without showing its
+    /// window, rendering each frame into an offscreen buffer with SDL's
+    /// software renderer, as fast as it can. Use this with
+    /// record_frame_timing(size_t) to measure a game where there's no
+    /// display, such as on a build server. Where there's no display, the
+    /// environment variables `SDL_VIDEODRIVER` and `SDL_AUDIODRIVER`
+    /// must be set to `dummy` before the game is constructed; setting
+    /// `GE211_OFFSCREEN` does that too.
+    void run_offscreen(long frames);
+
     /// The default background color of the window, if not changed by the
     /// derived class. To change the background color, assign the protected
     /// member variable Abstract_game::background_color from the
@@ -288,6 +304,30 @@ protected:
     /// function.
     void prepare(const sprites::Sprite&) const;
 
+    /// Starts recording how long each Frame_phase of each frame takes,
+    /// along with the latency of mouse clicks, keeping the most recent
+    /// `frames` frames. Calling it again changes the number kept, which
+    /// drops the frames recorded so far, but returns the same object, so
+    /// references to it stay good. The result can be used to show
+    /// a summary of the timings on the screen, or to save them when the
+    /// game quits:
+    ///
+    /// ```cpp
+    /// void My_game::on_start()
+    /// {
+    ///     Frame_timing& timing = record_frame_timing();
+    ///     timing.show_overlay(true);
+    ///     timing.save_on_quit("frames.csv", "frames.json");
+    /// }
+    /// ```
+    Frame_timing&
+    record_frame_timing(size_t frames = Frame_timing::default_capacity);
+
+    /// Returns the frame timings recorded since record_frame_timing(size_t)
+    /// was called, or nullptr if it hasn't been.
+    Frame_timing const* get_frame_timing() const NOEXCEPT
+    { return frame_timing_.get(); }
+
     ///@}
 
     /// Assign this member variable to change the window's background color
@@ -306,6 +346,7 @@ private:
     detail::Session session_;
     detail::lazy_ptr<Mixer> mixer_;
     detail::Engine* engine_ = nullptr;
+    std::unique_ptr<Frame_timing> frame_timing_;
 
     bool quit_ = false;
 
@@ -307,6 +307,7 @@ private:
     uint8_t blue_;
     uint8_t alpha_;
 
+    friend Glyph_atlas;
     friend Text_sprite;
     friend ::ge211::internal::Render_sprite;
 
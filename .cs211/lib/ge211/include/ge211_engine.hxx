@@ -1,10 +1,14 @@
 #pragma once
 
 #include "ge211_forward.hxx"
+#include "ge211_frame_timing.hxx"
 #include "ge211_noexcept.hxx"
 #include "ge211_render.hxx"
+#include "ge211_sprites.hxx"
 #include "ge211_window.hxx"
 
+#include <memory>
+
 namespace ge211 {
 
 namespace detail {
@@ -14,6 +18,11 @@ class Engine
 public:
     explicit Engine(Abstract_game&);
 
+    // Runs the game for at most `frames` frames with its window hidden,
+    // rendering into an offscreen buffer as fast as it can, for measuring
+    // it where there's no display.
+    Engine(Abstract_game&, long frames);
+
     void run();
     void prepare(const sprites::Sprite&) const;
     Window& get_window() NOEXCEPT;
@@ -23,11 +32,23 @@ public:
 private:
     void handle_events_(SDL_Event&);
     void paint_sprites_(Sprite_set&);
+    void paint_timing_overlay_(Frame_timing const&);
+    static Time_point event_time_(SDL_Event const&);
 
     Abstract_game& game_;
     Window window_;
     detail::Renderer renderer_;
+    detail::Render_batch batch_;
     bool is_focused_ = false;
+
+    // The number of frames left to render offscreen, or -1 if rendering
+    // to the window.
+    long offscreen_frames_ = -1;
+
+    // The frame timing overlay, made when it's first shown.
+    std::unique_ptr<Font> overlay_font_;
+    Text_sprite overlay_text_;
+    Time_point overlay_updated_;
 };
 
 } // end namespace detail
@@ -126,6 +126,8 @@ class Host_error : public Environment_error
     friend Mixer_error;
 
     /// Throwers
+    friend Atlas;
+    friend Glyph_atlas;
     friend Text_sprite;
     friend Window;
     friend ::ge211::internal::Render_sprite;
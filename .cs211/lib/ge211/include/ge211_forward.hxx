@@ -77,7 +77,12 @@ namespace sprites {
 
 class Sprite;
 
+class Atlas;
+class Atlas_sprite;
+class Canvas_sprite;
 class Circle_sprite;
+class Glyph_atlas;
+class Glyph_text_sprite;
 class Image_sprite;
 class Multiplexed_sprite;
 class Rectangle_sprite;
@@ -90,6 +95,10 @@ namespace time {
 class Duration;
 class Time_point;
 
+enum class Frame_phase;
+struct Frame_record;
+class Frame_timing;
+
 class Timer;
 class Pausable_timer;
 
@@ -119,6 +128,7 @@ namespace detail {
 class Engine;
 class File_resource;
 struct Placed_sprite;
+class Render_batch;
 class Renderer;
 class Session;
 class Texture;
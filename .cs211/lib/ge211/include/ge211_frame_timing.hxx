@@ -0,0 +1,169 @@
+#pragma once
+
+#include "ge211_forward.hxx"
+#include "ge211_noexcept.hxx"
+#include "ge211_time.hxx"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace ge211 {
+
+namespace time {
+
+/// The parts of a frame that the game engine times, in the order in which
+/// they happen.
+///
+/// \sa Abstract_game::record_frame_timing(size_t)
+enum class Frame_phase
+{
+    /// Handling input and window events, including the calls to
+    /// Abstract_game::on_key(Key), Abstract_game::on_mouse_down(Mouse_button,
+    /// Posn<int>), and the rest.
+    events,
+    /// Calling Abstract_game::on_frame(double) and polling the audio mixer.
+    on_frame,
+    /// Calling Abstract_game::draw(Sprite_set&).
+    draw,
+    /// Clearing the window and rendering the sprites into it, back to front.
+    paint,
+    /// Handing the finished frame to the display. With vsync, this waits
+    /// for the display to be ready for it.
+    present,
+    /// Sleeping to keep the frame rate down, when vsync can't.
+    sleep,
+};
+
+/// The number of Frame_phase%s.
+constexpr int frame_phase_count = 6;
+
+/// Returns the name of a Frame_phase, such as `"on_frame"`.
+char const* frame_phase_name(Frame_phase) NOEXCEPT;
+
+/// How long each phase of one frame took.
+struct Frame_record
+{
+    /// When the frame started.
+    Time_point start;
+
+    /// How long each phase took, indexed by Frame_phase.
+    Duration phases[frame_phase_count];
+
+    /// Whether a mouse button was pressed in time to be handled by this
+    /// frame, in which case `click` and `click_latency` say when, and how
+    /// long after that the frame was presented.
+    bool has_click = false;
+
+    /// When the earliest mouse button press handled by this frame happened,
+    /// according to the operating system.
+    Time_point click;
+
+    /// How long it took from `click` to presenting the frame that responded
+    /// to it: the click-to-photon latency, apart from the display's own lag.
+    Duration click_latency;
+
+    /// Returns how long a phase took.
+    Duration phase(Frame_phase phase) const NOEXCEPT
+    { return phases[int(phase)]; }
+
+    /// Returns how long the whole frame took.
+    Duration total() const NOEXCEPT;
+};
+
+/// The Frame_record%s of the most recent frames, kept in a ring buffer
+/// that's allocated once, so recording a frame doesn't allocate or lock.
+/// The game engine records into it once Abstract_game::record_frame_timing
+/// (size_t) has been called, and it can be read from the game's functions,
+/// or written out when the game quits.
+class Frame_timing
+{
+public:
+    /// The number of frames kept by default: a minute's worth at 60 Hz.
+    static const size_t default_capacity;
+
+    /// Constructs an empty record of the last `capacity` frames.
+    explicit Frame_timing(size_t capacity = default_capacity);
+
+    /// The number of frames kept, at most capacity().
+    size_t size() const NOEXCEPT;
+
+    /// The maximum number of frames kept.
+    size_t capacity() const NOEXCEPT;
+
+    /// The number of frames recorded in all, including the ones that have
+    /// since been dropped to make room.
+    uint64_t frames_recorded() const NOEXCEPT;
+
+    /// Returns one of the frames kept, oldest first.
+    ///
+    /// \preconditions
+    ///  - `index < size()`, or throws Client_logic_error.
+    Frame_record const& operator[](size_t index) const;
+
+    /// Writes the frames kept to `out` as CSV, one row per frame, with a
+    /// column for each phase in milliseconds.
+    void write_csv(std::ostream& out) const;
+
+    /// Writes the frames kept to `out` as a JSON trace in the Trace Event
+    /// Format, which Chrome's `about://tracing` and Perfetto can show. Each
+    /// phase is a slice on one track, and each click latency a slice on
+    /// another.
+    void write_trace(std::ostream& out) const;
+
+    /// Has the game engine write the frames kept to the given files, as by
+    /// write_csv(std::ostream&) const and write_trace(std::ostream&) const,
+    /// after Abstract_game::on_quit(). An empty file name writes nothing.
+    void save_on_quit(std::string const& csv_file,
+                      std::string const& trace_file = "");
+
+    /// Shows or hides a summary of the recent frames in the top-left
+    /// corner of the window.
+    void show_overlay(bool shown) NOEXCEPT;
+
+    /// Is the summary shown?
+    bool is_overlay_shown() const NOEXCEPT;
+
+    /// Returns the mean of each phase and of the click latencies over the
+    /// last `frames` frames kept, as a Frame_record; `has_click` is whether
+    /// any of them had a click.
+    Frame_record recent_mean(size_t frames) const NOEXCEPT;
+
+    /// Records a frame as though the game engine had timed it, dropping
+    /// the oldest frame kept if there's no room.
+    ///
+    /// This is intended for testing code that reads a Frame_timing, since
+    /// the frames the engine records depend on how long things really
+    /// take.
+    void record_for_testing(Frame_record const&) NOEXCEPT;
+
+private:
+    friend Abstract_game;
+    friend detail::Engine;
+
+    // Changes the capacity, dropping the frames kept, but not the one
+    // being recorded.
+    void resize_(size_t capacity);
+
+    void begin_frame_() NOEXCEPT;
+    void end_phase_(Frame_phase) NOEXCEPT;
+    void note_click_(Time_point) NOEXCEPT;
+    void end_frame_() NOEXCEPT;
+    void save_() const;
+
+    std::vector<Frame_record> records_;
+    uint64_t recorded_ = 0;
+
+    // The frame being recorded, and when its last phase ended.
+    Frame_record current_;
+    Time_point phase_start_;
+
+    std::string csv_file_;
+    std::string trace_file_;
+    bool overlay_shown_ = false;
+};
+
+} // end namespace time
+
+}
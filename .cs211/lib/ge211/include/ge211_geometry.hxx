@@ -657,6 +657,7 @@ struct Rect
     }
 
 private:
+    friend Atlas;
     friend Circle_sprite;
     friend ::ge211::internal::Render_sprite;
     friend class detail::Renderer;
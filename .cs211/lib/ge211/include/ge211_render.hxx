@@ -9,8 +9,10 @@
 
 #include <SDL_render.h>
 #include <SDL_surface.h>
+#include <SDL_version.h>
 
 #include <memory>
+#include <vector>
 
 namespace ge211 {
 
@@ -25,6 +27,12 @@ class Renderer
 public:
     explicit Renderer(const Window&);
 
+    // Renders into an offscreen buffer of the given size instead of a
+    // window, with SDL's software renderer, so it needs no display. What's
+    // rendered can be read back from offscreen_surface().
+    explicit Renderer(Dims<int>);
+
+    bool is_offscreen() const NOEXCEPT;
     bool is_vsync() const NOEXCEPT;
 
     void set_color(Color);
@@ -33,20 +41,67 @@ public:
     void copy(const Texture&, Posn<int>);
     void copy(const Texture&, Posn<int>, const Transform&);
 
+    // Copies just the `src` region of a texture.
+    void copy(const Texture&, Rect<int> src, Posn<int>);
+    void copy(const Texture&, Rect<int> src, Posn<int>, const Transform&);
+
+    // A copy of the `src` region of a texture to the `dst` rectangle,
+    // for copy_batch. The region is scaled if their sizes differ.
+    struct Region_copy
+    {
+        Rect<int> src;
+        Rect<int> dst;
+    };
+
+    // Copies many regions of one texture. Where SDL supports it, they're
+    // all sent to the graphics device in one call, which is much faster
+    // than copying them one at a time.
+    void copy_batch(const Texture&, const std::vector<Region_copy>&);
+
     // Prepares a texture for rendering with this given renderer, without
     // actually copying it.
     void prepare(const Texture&) const;
 
+    // Creates a texture that can be rendered onto, filled with the given
+    // color.
+    Texture create_target(Dims<int>, Color);
+
+    // Directs rendering to the given target texture, or back to the
+    // window if it's null.
+    void set_target(const Texture*);
+
+    // Counts the times the contents of target textures have been lost,
+    // which happens when the graphics device is reset. Target textures
+    // made before the count went up need to be drawn again.
+    unsigned long targets_lost() const NOEXCEPT;
+    void note_targets_lost() NOEXCEPT;
+
     void present() NOEXCEPT;
 
+    // For an offscreen renderer, returns the buffer rendered into, whose
+    // pixels are what the window would show after the last present();
+    // otherwise returns nullptr.
+    Borrowed<SDL_Surface> offscreen_surface() const NOEXCEPT;
+
 private:
     friend Texture;
 
     Borrowed<SDL_Renderer> get_raw_() const NOEXCEPT;
 
     static Owned<SDL_Renderer> create_renderer_(Borrowed<SDL_Window>);
+    static Owned<SDL_Surface> create_offscreen_(Dims<int>);
 
+    // The buffer an offscreen renderer renders into. It's declared first
+    // so that it outlives the renderer.
+    Uniq_SDL_Surface offscreen_;
     Uniq_SDL_Renderer ptr_;
+    unsigned long targets_lost_ = 0;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    // Scratch space for copy_batch, kept so it doesn't allocate each time.
+    std::vector<SDL_Vertex> batch_vertices_;
+    std::vector<int> batch_indices_;
+#endif
 };
 
 // A texture is initially created as a (device-independent) `SDL_Surface`,
@@ -65,6 +120,9 @@ public:
     explicit Texture(Owned<SDL_Surface> surface);
     explicit Texture(Uniq_SDL_Surface);
 
+    // Takes ownership of an `SDL_Texture` that's ready to render.
+    explicit Texture(Owned<SDL_Texture> texture);
+
     Dims<int> dimensions() const NOEXCEPT;
 
     // Returns nullptr if this `Texture` has been rendered, and can no
@@ -73,6 +131,9 @@ public:
 
     bool empty() const NOEXCEPT;
 
+    // Returns whether this and `other` are copies of the same texture.
+    bool same_as(const Texture& other) const NOEXCEPT;
+
 private:
     friend Renderer;
 
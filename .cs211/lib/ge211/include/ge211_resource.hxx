@@ -74,6 +74,7 @@ public:
     Font(const std::string& filename, int size);
 
 private:
+    friend Glyph_atlas;
     friend Text_sprite;
 
     Borrowed<TTF_Font> get_raw_() const NOEXCEPT { return ptr_.get(); }
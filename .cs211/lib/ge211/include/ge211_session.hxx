@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ge211_noexcept.hxx"
+
 #include <atomic>
 
 namespace ge211 {
@@ -16,6 +18,11 @@ struct PINNED
     PINNED& operator=(const PINNED&) = delete;
 };
 
+// Returns the number of frames the environment variable `GE211_OFFSCREEN`
+// asks to run offscreen for: 0 if it isn't set, or -1 if it isn't a
+// positive number.
+long offscreen_frames_from_env() NOEXCEPT;
+
 struct Sdl_session : PINNED
 {
     Sdl_session();
@@ -8,6 +8,7 @@
 #include "ge211_render.hxx"
 #include "ge211_resource.hxx"
 
+#include <cstdint>
 #include <vector>
 #include <sstream>
 
@@ -53,12 +54,22 @@ private:
     friend class detail::Engine;
     friend struct detail::Placed_sprite;
     friend Multiplexed_sprite;
+    friend Canvas_sprite;
+    friend class detail::Render_batch;
 
     virtual void render(detail::Renderer&,
                         Posn<int>,
                         Transform const&) const = 0;
 
     virtual void prepare(detail::Renderer const&) const {}
+
+    // A sprite that's a region of a bigger texture returns the texture
+    // and sets `src` to the region, so that it can be drawn in a batch
+    // with other regions of the same texture. Others return null.
+    virtual detail::Texture const* texture_region_(Rect<int>& /*src*/) const
+    {
+        return nullptr;
+    }
 };
 
 } // end namespace sprites
@@ -85,6 +96,26 @@ private:
     virtual Texture const& get_texture_() const = 0;
 };
 
+// Collects sprites that are regions of the same texture, such as the
+// sprites of an `Atlas`, as they're rendered one after another, so that
+// they can all be copied in one batch.
+class Render_batch
+{
+public:
+    // Adds a sprite to the batch, first rendering the batch so far if the
+    // sprite is a region of a different texture. If the sprite can't join
+    // a batch, renders the batch so far and returns false, and then the
+    // caller should render the sprite by itself.
+    bool add(Renderer&, Sprite const&, Posn<int>, Transform const&);
+
+    // Renders the batch so far, and empties it.
+    void flush(Renderer&);
+
+private:
+    Texture texture_;
+    std::vector<Renderer::Region_copy> copies_;
+};
+
 } // end namespace detail
 
 namespace internal {
@@ -222,7 +253,10 @@ public:
 private:
     detail::Texture const& get_texture_() const override;
 
+    friend Atlas;
+
     static detail::Texture load_texture_(std::string const& filename);
+    static Owned<SDL_Surface> load_surface_(std::string const& filename);
 
     detail::Texture texture_;
 };
@@ -470,6 +504,195 @@ private:
     Timer since_;
 };
 
+/// A Sprite that shows one of the images of an @ref Atlas.
+class Atlas_sprite : public Sprite
+{
+public:
+    Dims<int> dimensions() const override;
+
+private:
+    friend Atlas;
+
+    Atlas_sprite(detail::Texture const&, Rect<int> src);
+
+    void render(detail::Renderer&, Posn<int>,
+                Transform const&) const override;
+    void prepare(detail::Renderer const&) const override;
+    detail::Texture const* texture_region_(Rect<int>& src) const override;
+
+    detail::Texture texture_;
+    Rect<int> src_;
+};
+
+/// Several images packed into one texture, each of which can be drawn as
+/// a sprite of its own. When sprites from the same atlas are drawn one
+/// after another, such as the tiles of a game board, they're sent to the
+/// graphics device in one batch, which is much faster than drawing
+/// separate @ref Image_sprite%s one at a time.
+class Atlas
+{
+public:
+    /// Loads the given image files, as @ref Image_sprite does, and packs
+    /// them into one atlas.
+    explicit Atlas(std::vector<std::string> const& filenames);
+
+    /// Returns the number of images in the atlas.
+    size_t size() const;
+
+    /// Returns the sprite for the image loaded from `filenames[i]`.
+    Atlas_sprite const& operator[](size_t i) const;
+
+private:
+    friend Glyph_atlas;
+
+    // Packs images into one texture, setting `places` to where each went.
+    static detail::Texture
+    pack_(std::vector<detail::Uniq_SDL_Surface> const& images,
+          std::vector<Rect<int>>& places);
+
+    detail::Texture texture_;
+    std::vector<Atlas_sprite> sprites_;
+};
+
+/// The glyphs of some characters of a @ref Font, each rendered once and
+/// packed into one texture, for text that changes often, such as a score
+/// or a clock. A @ref Glyph_text_sprite shows text made of them, and
+/// changing its text needs no font rendering and no new texture, just a
+/// different choice of glyphs.
+///
+/// Glyphs are placed side by side by their widths, without kerning, so
+/// this suits fonts whose characters line up on their own, such as digits.
+class Glyph_atlas
+{
+public:
+    /// Renders each character of `characters`, a UTF-8 string, in the
+    /// given font and color.
+    Glyph_atlas(Font const& font,
+                std::string const& characters,
+                Color color = Color::white());
+
+    /// Does the atlas have a glyph for the character with the given code
+    /// point?
+    bool contains(uint32_t code_point) const NOEXCEPT;
+
+    /// Returns the height of the glyphs, which is the height of every
+    /// line of text made from them.
+    int height() const NOEXCEPT;
+
+private:
+    friend Glyph_text_sprite;
+
+    struct Glyph_
+    {
+        uint32_t code_point;
+        Rect<int> src;
+    };
+
+    // Returns the glyph for a code point, or nullptr if there isn't one.
+    Glyph_ const* find_(uint32_t code_point) const NOEXCEPT;
+
+    detail::Texture texture_;
+    // Sorted by code point.
+    std::vector<Glyph_> glyphs_;
+    int height_ = 0;
+};
+
+/// A Sprite that shows one line of text made from the glyphs of a
+/// @ref Glyph_atlas. Changing its text with set_text(std::string const&)
+/// is cheap, so it can be done every frame, and the whole line is drawn in
+/// one batch. Transforms can scale it, but don't rotate or flip it.
+class Glyph_text_sprite : public Sprite
+{
+public:
+    /// Constructs a text sprite using the glyphs of `atlas`, which must
+    /// outlive it, showing `text`.
+    ///
+    /// \preconditions
+    ///  - As for set_text(std::string const&).
+    explicit Glyph_text_sprite(Glyph_atlas const& atlas,
+                               std::string const& text = "");
+
+    /// Changes the text shown.
+    ///
+    /// \preconditions
+    ///  - `text` is valid UTF-8, and the atlas has a glyph for each of its
+    ///    characters, or throws Client_logic_error.
+    void set_text(std::string const& text);
+
+    /// Returns the text shown.
+    std::string const& text() const NOEXCEPT;
+
+    Dims<int> dimensions() const override;
+
+private:
+    void render(detail::Renderer&, Posn<int>,
+                Transform const&) const override;
+    void prepare(detail::Renderer const&) const override;
+
+    Glyph_atlas const* atlas_;
+    std::string text_;
+    // Where in the atlas each glyph of the text is, left to right.
+    std::vector<Rect<int>> glyphs_;
+    Dims<int> dims_;
+    mutable std::vector<detail::Renderer::Region_copy> copies_;
+};
+
+/// A Sprite that keeps what's drawn on it from one frame to the next.
+/// Other sprites are drawn onto it with draw(), and stay there until
+/// something else is drawn over them, so a scene that changes a little at
+/// a time only needs to draw the parts that change. Drawing happens the
+/// next time the canvas itself is rendered, so the sprites drawn must
+/// still exist then.
+///
+/// What's on a canvas can be lost if the graphics device is reset, which
+/// check_lost() reports, so that everything can be drawn again.
+class Canvas_sprite : public Sprite
+{
+public:
+    /// Constructs a canvas with the given dimensions, filled with the
+    /// given color.
+    explicit Canvas_sprite(Dims<int>, Color = Color::black());
+
+    Dims<int> dimensions() const override;
+
+    /// Draws `sprite` onto the canvas with its top-left corner at `xy`,
+    /// relative to the top-left corner of the canvas, with the given
+    /// transform.
+    void draw(Sprite const& sprite, Posn<int> xy,
+              Transform const& transform = Transform());
+
+    /// Fills the canvas with its original color again, and forgets
+    /// anything drawn on it since it was last rendered.
+    void clear();
+
+    /// Returns whether the canvas has lost what was drawn on it since this
+    /// was last called, leaving it filled with its original color.
+    bool check_lost();
+
+private:
+    struct Stamp_
+    {
+        const Sprite* sprite;
+        Posn<int> xy;
+        Transform transform;
+    };
+
+    void render(detail::Renderer&, Posn<int>,
+                Transform const&) const override;
+
+    Dims<int> dims_;
+    Color color_;
+
+    // The texture is made the first time the canvas is rendered, since
+    // that needs the renderer, and the stamps wait until then.
+    mutable detail::Texture texture_;
+    mutable std::vector<Stamp_> stamps_;
+    mutable detail::Render_batch batch_;
+    mutable unsigned long targets_lost_ = 0;
+    mutable bool lost_ = false;
+    mutable bool cleared_ = false;
+};
+
 } // end namespace sprites
 
 namespace detail {
@@ -479,15 +702,113 @@ struct Placed_sprite
     const Sprite* sprite;
     Posn<int> xy;
     int z;
-    Transform transform;
+    // Which of the transforms of the Sprite_layers it's in to draw it with.
+    // Most sprites aren't transformed, and they all share transform 0, the
+    // identity, rather than carrying a copy of it.
+    uint32_t transform;
 
-    Placed_sprite(Sprite const&, Posn<int>, int, Transform const&) NOEXCEPT;
+    Placed_sprite(Sprite const&, Posn<int>, int, uint32_t = 0) NOEXCEPT;
 
-    void render(Renderer&) const;
+    void render(Renderer&, Transform const&) const;
 };
 
 bool operator<(Placed_sprite const&, Placed_sprite const&) NOEXCEPT;
 
+// Placed sprites kept in a bucket for each *z* coordinate, lowest first,
+// with each bucket in the order its sprites were added. Visiting them in
+// that order draws them back to front without sorting, and sprites at the
+// same *z* come out in a predictable order. The buckets are kept from
+// frame to frame, so once they've grown, adding sprites doesn't allocate.
+//
+// Sprites can also be retained, which keeps them from one clear to the
+// next, until they're released. In each bucket the retained sprites come
+// before the ones added since the last clear.
+class Sprite_layers
+{
+public:
+    Sprite_layers();
+
+    void add(Sprite const&, Posn<int>, int z, Transform const&);
+
+    // Where a retained sprite is kept: its slot, and the generation of the
+    // slot when the sprite was retained. Releasing the sprite moves the
+    // slot on to its next generation, so that a Slot kept from before
+    // then can't find the next sprite kept there.
+    struct Slot
+    {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    // Retains a sprite, returning the slot it's kept in.
+    Slot retain(Sprite const&, Posn<int>, int z, Transform const&);
+
+    // Returns the retained sprite in a slot, which can be changed in place,
+    // or nullptr if the slot doesn't hold it any more.
+    Placed_sprite* retained(Slot) NOEXCEPT;
+
+    // Releases the retained sprite in a slot, which must hold it.
+    void release(Slot);
+
+    // Calls `visit(placed, transform)` on every sprite, back to front.
+    template <typename VISITOR>
+    void for_each(VISITOR visit) const
+    {
+        for (Layer_ const& layer : layers_) {
+            for (uint32_t slot : layer.retained) {
+                Placed_sprite const& placed = slots_[slot];
+                if (placed.sprite)
+                    visit(placed, retained_transforms_[placed.transform]);
+            }
+            for (Placed_sprite const& placed : layer.sprites)
+                visit(placed, transforms_[placed.transform]);
+        }
+    }
+
+    // The number of sprites, retained or not.
+    size_t size() const NOEXCEPT;
+
+    // Empties the buckets of the sprites that aren't retained, keeping
+    // their memory, and drops the buckets that weren't used since the
+    // last clear.
+    void clear();
+
+private:
+    struct Layer_
+    {
+        int z;
+        // The slots of the retained sprites, in the order they were
+        // retained. Released ones stay until the next clear.
+        std::vector<uint32_t> retained;
+        size_t released;
+        std::vector<Placed_sprite> sprites;
+    };
+
+    std::vector<Layer_> layers_;
+
+    // The bucket of the last sprite added, since the next one usually
+    // goes in the same one.
+    size_t last_ = 0;
+    size_t size_ = 0;
+
+    // The transforms of the sprites that aren't retained; the first is
+    // the identity.
+    std::vector<Transform> transforms_;
+
+    // The retained sprites, a slot each, and their transforms, with the
+    // identity first. A released slot has no sprite, and is only reused
+    // after the next clear has taken it out of its bucket.
+    std::vector<Placed_sprite> slots_;
+    std::vector<uint32_t> generations_;
+    std::vector<uint32_t> free_slots_;
+    std::vector<Transform> retained_transforms_;
+    std::vector<uint32_t> free_transforms_;
+    size_t retained_count_ = 0;
+    bool any_released_ = false;
+
+    Layer_& layer_(int z);
+};
+
 } // end namespace detail
 
 /// A collection of positioned [Sprite](@ref ge211::sprites::Sprite)s
@@ -499,7 +820,14 @@ bool operator<(Placed_sprite const&, Placed_sprite const&) NOEXCEPT;
 /// coordinate that determines stacking order. Each sprite may have a
 /// [Transform] applied as well.
 ///
+/// The set is empty apart from its retained sprites, which stay in it
+/// from frame to frame until they're released. Retaining the sprites
+/// that are drawn every frame in the same place, such as a background,
+/// saves adding them again each time.
+///
 /// \sa Sprite_set::add_sprite(Sprite const&, Posn<int>, int, Transform const&)
+/// \sa Sprite_set::retain_sprite(Sprite const&, Posn<int>, int,
+/// Transform const&)
 /// \sa `class` [Sprite]
 /// \sa `class` [Transform]
 ///
@@ -516,9 +844,8 @@ public:
     /// corner of the window.
     /// \param z (*optional*, defaults to 0) The *z* coordinate, which
     /// determines the relative layering of all the sprites in the window.
-    /// The layering of sprites placed with the same *z* is unspecified and
-    /// not related to the order in which they were added, so you may need to
-    /// specify *z* if sprites overlap and you care which appears in front.
+    /// Sprites placed with the same *z* are layered in the order in which
+    /// they were added, so later ones appear in front.
     /// \param transform (*optional*, defaults to the identity transform)
     /// A [Transform] allows scaling, flipping, and rotating the [Sprite]
     /// when it is rendered.
@@ -544,11 +871,77 @@ public:
                            int z = 0,
                            Transform const& transform = Transform());
 
+    /// Identifies a sprite retained in a Sprite_set. A default-constructed
+    /// handle identifies no sprite. Copies of a handle all identify the
+    /// same sprite, and once it's released, none of them identifies any
+    /// sprite, even one retained later in its place.
+    class Handle
+    {
+    public:
+        /// Constructs a handle that identifies no sprite.
+        Handle() NOEXCEPT;
+
+        /// Does this handle identify a sprite?
+        explicit operator bool() const NOEXCEPT;
+
+    private:
+        friend Sprite_set;
+
+        explicit Handle(detail::Sprite_layers::Slot) NOEXCEPT;
+
+        uint32_t slot_;
+        uint32_t generation_;
+    };
+
+    /// Adds the given sprite to the sprite set to render it in every frame
+    /// from the next one on, until it's released with release_sprite(Handle).
+    /// The parameters are as for add_sprite(Sprite const&, Posn<int>, int,
+    /// Transform const&). Sprites retained with the same *z* are layered
+    /// in the order in which they were retained, behind the ones added
+    /// with that *z* by add_sprite.
+    ///
+    /// \return a handle to change or release the sprite with
+    ///
+    /// \ownership
+    ///
+    /// As with add_sprite, the Sprite_set borrows the sprite, which needs
+    /// to be owned by some other object that outlives it until it's
+    /// released or replaced by change_sprite(Handle, Sprite const&).
+    Handle retain_sprite(Sprite const& sprite,
+                         Posn<int> xy,
+                         int z = 0,
+                         Transform const& transform = Transform());
+
+    /// Replaces a retained sprite with another one, keeping its position.
+    /// This is for sprites whose picture changes, such as a button.
+    ///
+    /// \preconditions
+    ///  - `handle` identifies a sprite retained in this set that hasn't been
+    ///    released, or throws Client_logic_error.
+    Sprite_set& change_sprite(Handle handle, Sprite const& sprite);
+
+    /// Moves a retained sprite to a new (*x*, *y*) position.
+    ///
+    /// \preconditions
+    ///  - `handle` identifies a sprite retained in this set that hasn't been
+    ///    released, or throws Client_logic_error.
+    Sprite_set& move_sprite(Handle handle, Posn<int> xy);
+
+    /// Stops rendering a retained sprite. The handle identifies no sprite
+    /// afterward.
+    ///
+    /// \preconditions
+    ///  - `handle` identifies a sprite retained in this set that hasn't been
+    ///    released, or throws Client_logic_error.
+    void release_sprite(Handle& handle);
+
 private:
     friend class detail::Engine;
 
     Sprite_set();
-    std::vector<detail::Placed_sprite> sprites_;
+    detail::Sprite_layers layers_;
+
+    detail::Placed_sprite& retained_(Handle, char const* who);
 };
 
 }
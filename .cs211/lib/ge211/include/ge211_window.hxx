@@ -59,7 +59,7 @@ private:
     friend class detail::Engine;
     friend class detail::Renderer;
 
-    Window(const std::string&, Dims<int> dim);
+    Window(const std::string&, Dims<int> dim, bool shown = true);
 
     Borrowed<SDL_Window> get_raw_() const NOEXCEPT { return ptr_.get(); }
     uint32_t get_flags_() const NOEXCEPT;
@@ -4,6 +4,8 @@
 
 #include <SDL.h>
 
+#include <algorithm>
+
 namespace ge211 {
 
 using namespace detail;
@@ -28,9 +30,25 @@ std::string Abstract_game::initial_window_title() const
 
 void Abstract_game::run()
 {
+    long frames = offscreen_frames_from_env();
+    if (frames > 0) {
+        run_offscreen(frames);
+        return;
+    }
+
+    if (frames < 0) {
+        internal::logging::warn()
+            << "Abstract_game::run: GE211_OFFSCREEN should be a positive "
+            << "number of frames; running on screen instead";
+    }
     Engine(*this).run();
 }
 
+void Abstract_game::run_offscreen(long frames)
+{
+    Engine(*this, frames).run();
+}
+
 void Abstract_game::quit() NOEXCEPT
 {
     quit_ = true;
@@ -55,6 +73,18 @@ void Abstract_game::prepare(const sprites::Sprite& sprite) const
     }
 }
 
+Frame_timing& Abstract_game::record_frame_timing(size_t frames)
+{
+    // The engine holds on to the Frame_timing during a frame, which may
+    // be when this is called, so it's resized rather than replaced.
+    if (!frame_timing_)
+        frame_timing_.reset(new Frame_timing(frames));
+    else if (frame_timing_->capacity() != std::max(frames, size_t(1)))
+        frame_timing_->resize_(frames);
+
+    return *frame_timing_;
+}
+
 void Abstract_game::mark_present_() NOEXCEPT
 {
     busy_time_.pause();
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <iomanip>
 
 namespace ge211 {
 
@@ -28,6 +29,17 @@ Engine::Engine(Abstract_game& game)
     game_.engine_ = this;
 }
 
+Engine::Engine(Abstract_game& game, long frames)
+        : game_{game},
+          window_{game_.initial_window_title(),
+                  game_.initial_window_dimensions(),
+                  false},
+          renderer_{game_.initial_window_dimensions()},
+          offscreen_frames_{std::max(frames, 0L)}
+{
+    game_.engine_ = this;
+}
+
 Engine::~Engine()
 {
     game_.engine_ = nullptr;
@@ -48,25 +60,46 @@ void Engine::run()
     try {
         game_.on_start();
 
-        while (!game_.quit_) {
+        while (!game_.quit_ && offscreen_frames_ != 0) {
+            // Timing is on once the game has asked for it, which it may
+            // do from any of its functions. Asking again resizes the same
+            // Frame_timing, so this pointer stays good all frame.
+            Frame_timing* timing = game_.frame_timing_.get();
+            auto end_phase = [&](Frame_phase phase) {
+                if (timing) timing->end_phase_(phase);
+            };
+
+            if (timing) timing->begin_frame_();
             handle_events_(e);
+            end_phase(Frame_phase::events);
+
             game_.on_frame(game_.get_prev_frame_length().seconds());
             game_.poll_channels_();
+            end_phase(Frame_phase::on_frame);
+
             game_.draw(sprites);
+            end_phase(Frame_phase::draw);
 
             renderer_.set_color(game_.background_color);
             renderer_.clear();
             paint_sprites_(sprites);
+            if (timing && timing->is_overlay_shown())
+                paint_timing_overlay_(*timing);
+            end_phase(Frame_phase::paint);
 
             game_.mark_present_();
             renderer_.present();
+            end_phase(Frame_phase::present);
 
             Duration allowed_frame_length =
                     (is_focused_ && has_vsync)?
                     min_frame_length : software_frame_length;
 
             auto frame_length = game_.frame_start_.elapsed_time();
-            if (frame_length < allowed_frame_length) {
+            if (offscreen_frames_ > 0) {
+                --offscreen_frames_;
+                game_.mark_frame_();
+            } else if (frame_length < allowed_frame_length) {
                 auto duration = allowed_frame_length - frame_length;
                 duration.sleep_for();
                 game_.mark_frame_();
@@ -76,9 +109,15 @@ void Engine::run()
             } else {
                 game_.mark_frame_();
             }
+
+            if (timing) {
+                end_phase(Frame_phase::sleep);
+                timing->end_frame_();
+            }
         }
 
         game_.on_quit();
+        if (game_.frame_timing_) game_.frame_timing_->save_();
     } catch (const Exception_base& e) {
         internal::logging::fatal()
             << "Uncaught exception:\n  "
@@ -123,6 +162,8 @@ void Engine::handle_events_(SDL_Event& e)
                 break;
 
             case SDL_MOUSEBUTTONDOWN: {
+                if (game_.frame_timing_)
+                    game_.frame_timing_->note_click_(event_time_(e));
                 Mouse_button button;
                 if (map_button(e.button.button, button))
                     game_.on_mouse_down(button, {e.button.x, e.button.y});
@@ -155,6 +196,11 @@ void Engine::handle_events_(SDL_Event& e)
                 }
                 break;
 
+            case SDL_RENDER_TARGETS_RESET:
+            case SDL_RENDER_DEVICE_RESET:
+                renderer_.note_targets_lost();
+                break;
+
             default:
                 ;
         }
@@ -163,18 +209,49 @@ void Engine::handle_events_(SDL_Event& e)
 
 void Engine::paint_sprites_(Sprite_set& sprite_set)
 {
-    auto& vec   = sprite_set.sprites_;
-    auto  begin = vec.begin(),
-          end   = vec.end();
+    // Sprites that are regions of one texture, such as the sprites of an
+    // Atlas, are batched while they come one after another.
+    sprite_set.layers_.for_each([this](Placed_sprite const& placed,
+                                       Transform const& transform) {
+        if (!batch_.add(renderer_, *placed.sprite, placed.xy, transform))
+            placed.render(renderer_, transform);
+    });
+    batch_.flush(renderer_);
+
+    sprite_set.layers_.clear();
+}
 
-    std::make_heap(begin, end);
+Time_point Engine::event_time_(SDL_Event const& e)
+{
+    // SDL stamps events with its millisecond tick count when they arrive,
+    // which may be some time before they're handled.
+    Uint32 age = SDL_GetTicks() - e.common.timestamp;
+    return Time_point::now() - Duration(age / 1000.0);
+}
 
-    while (begin != end) {
-        std::pop_heap(begin, end--);
-        end->render(renderer_);
+void Engine::paint_timing_overlay_(Frame_timing const& timing)
+{
+    // The text is only rendered again twice a second, so it can be read,
+    // and so that rendering it doesn't cost much.
+    Time_point now = Time_point::now();
+    if (!overlay_font_ || now - overlay_updated_ > Duration(0.5)) {
+        if (!overlay_font_) overlay_font_.reset(new Font("sans.ttf", 14));
+        overlay_updated_ = now;
+
+        Frame_record mean = timing.recent_mean(30);
+        Text_sprite::Builder builder(*overlay_font_);
+        builder.color(Color::white()) << std::fixed << std::setprecision(2)
+                << mean.total().seconds() * 1000 << " ms/frame:";
+        for (int phase = 0; phase < frame_phase_count; ++phase) {
+            builder << ' ' << frame_phase_name(Frame_phase(phase)) << ' '
+                    << mean.phases[phase].seconds() * 1000;
+        }
+        if (mean.has_click)
+            builder << "  click " << mean.click_latency.seconds() * 1000;
+        overlay_text_.reconfigure(builder);
     }
 
-    vec.clear();
+    Placed_sprite(overlay_text_, {4, 4}, 0).render(renderer_, Transform());
 }
 
 Window& Engine::get_window() NOEXCEPT
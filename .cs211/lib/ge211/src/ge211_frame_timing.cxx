@@ -0,0 +1,225 @@
+#include "ge211_frame_timing.hxx"
+#include "ge211_error.hxx"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+
+namespace ge211 {
+
+namespace time {
+
+using namespace internal;
+
+const size_t Frame_timing::default_capacity = 3600;
+
+static char const* const phase_names[frame_phase_count] = {
+        "events", "on_frame", "draw", "paint", "present", "sleep",
+};
+
+char const* frame_phase_name(Frame_phase phase) NOEXCEPT
+{
+    return phase_names[int(phase)];
+}
+
+Duration Frame_record::total() const NOEXCEPT
+{
+    Duration result;
+    for (Duration phase : phases) result += phase;
+    return result;
+}
+
+Frame_timing::Frame_timing(size_t capacity)
+        : records_(std::max(capacity, size_t(1)))
+{ }
+
+size_t Frame_timing::size() const NOEXCEPT
+{
+    return size_t(std::min(recorded_, uint64_t(records_.size())));
+}
+
+size_t Frame_timing::capacity() const NOEXCEPT
+{
+    return records_.size();
+}
+
+uint64_t Frame_timing::frames_recorded() const NOEXCEPT
+{
+    return recorded_;
+}
+
+Frame_record const& Frame_timing::operator[](size_t index) const
+{
+    if (index >= size())
+        throw Client_logic_error("Frame_timing::operator[]: out of range");
+    return records_[(recorded_ - size() + index) % records_.size()];
+}
+
+void Frame_timing::write_csv(std::ostream& out) const
+{
+    out << "frame,start_ms";
+    for (char const* name : phase_names) out << ',' << name << "_ms";
+    out << ",total_ms,click_latency_ms\n";
+
+    if (size() == 0) return;
+
+    Time_point origin = (*this)[0].start;
+    uint64_t first = recorded_ - size();
+    out << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < size(); ++i) {
+        Frame_record const& record = (*this)[i];
+        out << first + i << ','
+            << 1000 * (record.start - origin).seconds();
+        for (Duration phase : record.phases)
+            out << ',' << 1000 * phase.seconds();
+        out << ',' << 1000 * record.total().seconds() << ',';
+        if (record.has_click)
+            out << 1000 * record.click_latency.seconds();
+        out << '\n';
+    }
+}
+
+void Frame_timing::write_trace(std::ostream& out) const
+{
+    // Times are in microseconds, from the start of the first frame kept.
+    Time_point origin = size() ? (*this)[0].start : Time_point();
+    auto micros = [&](Time_point when) {
+        return 1e6 * (when - origin).seconds();
+    };
+
+    out << std::fixed << std::setprecision(1)
+        << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+        << "\"args\":{\"name\":\"frames\"}},\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,"
+        << "\"args\":{\"name\":\"click latency\"}}";
+
+    for (size_t i = 0; i < size(); ++i) {
+        Frame_record const& record = (*this)[i];
+        Time_point phase_start = record.start;
+        for (int phase = 0; phase < frame_phase_count; ++phase) {
+            out << ",\n{\"name\":\"" << phase_names[phase]
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+                << micros(phase_start) << ",\"dur\":"
+                << 1e6 * record.phases[phase].seconds() << '}';
+            phase_start += record.phases[phase];
+        }
+        if (record.has_click) {
+            out << ",\n{\"name\":\"click\",\"ph\":\"X\",\"pid\":1,"
+                << "\"tid\":2,\"ts\":" << micros(record.click)
+                << ",\"dur\":" << 1e6 * record.click_latency.seconds()
+                << '}';
+        }
+    }
+
+    out << "\n]}\n";
+}
+
+void Frame_timing::save_on_quit(std::string const& csv_file,
+                                std::string const& trace_file)
+{
+    csv_file_ = csv_file;
+    trace_file_ = trace_file;
+}
+
+void Frame_timing::show_overlay(bool shown) NOEXCEPT
+{
+    overlay_shown_ = shown;
+}
+
+bool Frame_timing::is_overlay_shown() const NOEXCEPT
+{
+    return overlay_shown_;
+}
+
+Frame_record Frame_timing::recent_mean(size_t frames) const NOEXCEPT
+{
+    Frame_record result;
+    frames = std::min(frames, size());
+    if (frames == 0) return result;
+
+    int clicks = 0;
+    for (size_t i = size() - frames; i < size(); ++i) {
+        Frame_record const& record =
+                records_[(recorded_ - size() + i) % records_.size()];
+        for (int phase = 0; phase < frame_phase_count; ++phase)
+            result.phases[phase] += record.phases[phase];
+        if (record.has_click) {
+            result.click_latency += record.click_latency;
+            ++clicks;
+        }
+    }
+
+    for (Duration& phase : result.phases) phase /= double(frames);
+    if (clicks) {
+        result.has_click = true;
+        result.click_latency /= double(clicks);
+    }
+    return result;
+}
+
+void Frame_timing::record_for_testing(Frame_record const& record) NOEXCEPT
+{
+    records_[recorded_ % records_.size()] = record;
+    ++recorded_;
+}
+
+void Frame_timing::resize_(size_t capacity)
+{
+    records_.assign(std::max(capacity, size_t(1)), Frame_record());
+    recorded_ = 0;
+}
+
+void Frame_timing::begin_frame_() NOEXCEPT
+{
+    current_ = Frame_record();
+    current_.start = phase_start_ = Time_point::now();
+}
+
+void Frame_timing::end_phase_(Frame_phase phase) NOEXCEPT
+{
+    Time_point now = Time_point::now();
+    current_.phases[int(phase)] = now - phase_start_;
+    phase_start_ = now;
+
+    if (phase == Frame_phase::present && current_.has_click)
+        current_.click_latency = now - current_.click;
+}
+
+void Frame_timing::note_click_(Time_point when) NOEXCEPT
+{
+    if (!current_.has_click || when < current_.click) {
+        current_.has_click = true;
+        current_.click = when;
+    }
+}
+
+void Frame_timing::end_frame_() NOEXCEPT
+{
+    records_[recorded_ % records_.size()] = current_;
+    ++recorded_;
+}
+
+void Frame_timing::save_() const
+{
+    if (!csv_file_.empty()) {
+        std::ofstream out(csv_file_);
+        write_csv(out);
+        if (!out)
+            logging::warn() << "Frame_timing: could not write "
+                            << csv_file_;
+    }
+
+    if (!trace_file_.empty()) {
+        std::ofstream out(trace_file_);
+        write_trace(out);
+        if (!out)
+            logging::warn() << "Frame_timing: could not write "
+                            << trace_file_;
+    }
+}
+
+} // end namespace time
+
+}
@@ -72,6 +72,35 @@ Renderer::Renderer(const Window& window)
         throw Host_error{"Could not initialize renderer."};
 }
 
+SDL_Surface* Renderer::create_offscreen_(Dims<int> dims)
+{
+    return SDL_CreateRGBSurfaceWithFormat(0, dims.width, dims.height, 32,
+                                          SDL_PIXELFORMAT_RGBA32);
+}
+
+Renderer::Renderer(Dims<int> dims)
+        : offscreen_{create_offscreen_(dims)}
+{
+    if (!offscreen_)
+        throw Host_error{"Could not create offscreen buffer."};
+
+    ptr_ = SDL_CreateSoftwareRenderer(offscreen_.get());
+    if (!ptr_)
+        throw Host_error{"Could not initialize offscreen renderer."};
+
+    SDL_SetRenderDrawBlendMode(get_raw_(), SDL_BLENDMODE_BLEND);
+}
+
+bool Renderer::is_offscreen() const NOEXCEPT
+{
+    return bool(offscreen_);
+}
+
+SDL_Surface* Renderer::offscreen_surface() const NOEXCEPT
+{
+    return offscreen_.get();
+}
+
 bool Renderer::is_vsync() const NOEXCEPT
 {
     SDL_RendererInfo info;
@@ -152,11 +181,144 @@ void Renderer::copy(const Texture& texture,
     }
 }
 
+void Renderer::copy(const Texture& texture, Rect<int> src, Posn<int> xy)
+{
+    auto raw_texture = texture.get_raw_(*this);
+    if (!raw_texture) return;
+
+    SDL_Rect srcrect = src;
+    SDL_Rect dstrect = Rect<int>::from_top_left(xy, src.dimensions());
+
+    int render_result = SDL_RenderCopy(get_raw_(), raw_texture,
+                                       &srcrect, &dstrect);
+    if (render_result < 0) {
+        warn_sdl() << "Could not render texture";
+    }
+}
+
+void Renderer::copy(const Texture& texture,
+                    Rect<int> src,
+                    Posn<int> xy,
+                    const Transform& transform)
+{
+    auto raw_texture = texture.get_raw_(*this);
+    if (!raw_texture) return;
+
+    SDL_Rect srcrect = src;
+    SDL_Rect dstrect = Rect<int>::from_top_left(xy, src.dimensions());
+    dstrect.w = int(dstrect.w * transform.get_scale_x());
+    dstrect.h = int(dstrect.h * transform.get_scale_y());
+
+    SDL_RendererFlip flip = SDL_FLIP_NONE;
+    if (transform.get_flip_h()) flip |= SDL_FLIP_HORIZONTAL;
+    if (transform.get_flip_v()) flip |= SDL_FLIP_VERTICAL;
+
+    int render_result = SDL_RenderCopyEx(
+            get_raw_(), raw_texture,
+            &srcrect, &dstrect,
+            transform.get_rotation(), nullptr,
+            flip);
+
+    if (render_result < 0) {
+        warn_sdl() << "Could not render texture";
+    }
+}
+
+void Renderer::copy_batch(const Texture& texture,
+                          const std::vector<Region_copy>& copies)
+{
+    auto raw_texture = texture.get_raw_(*this);
+    if (!raw_texture || copies.empty()) return;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    // Each copy is a quad of two triangles, with texture coordinates
+    // scaled to the texture.
+    Dims<int> dims = texture.dimensions();
+    float u_scale = 1.0f / float(dims.width);
+    float v_scale = 1.0f / float(dims.height);
+    SDL_Color white{255, 255, 255, 255};
+
+    batch_vertices_.clear();
+    batch_indices_.clear();
+    for (const Region_copy& copy : copies) {
+        int first = int(batch_vertices_.size());
+        for (int corner = 0; corner < 4; ++corner) {
+            bool right = (corner & 1) != 0;
+            bool bottom = (corner & 2) != 0;
+            SDL_Vertex vertex;
+            vertex.position = {
+                    float(copy.dst.x + (right ? copy.dst.width : 0)),
+                    float(copy.dst.y + (bottom ? copy.dst.height : 0))};
+            vertex.color = white;
+            vertex.tex_coord = {
+                    float(copy.src.x + (right ? copy.src.width : 0)) *
+                    u_scale,
+                    float(copy.src.y + (bottom ? copy.src.height : 0)) *
+                    v_scale};
+            batch_vertices_.push_back(vertex);
+        }
+        for (int corner : {0, 1, 2, 2, 1, 3})
+            batch_indices_.push_back(first + corner);
+    }
+
+    if (SDL_RenderGeometry(get_raw_(), raw_texture,
+                           batch_vertices_.data(),
+                           int(batch_vertices_.size()),
+                           batch_indices_.data(),
+                           int(batch_indices_.size())) == 0)
+        return;
+
+    // Some renderers can't draw geometry, so fall back on copying.
+#endif
+
+    for (const Region_copy& copy : copies) {
+        SDL_Rect srcrect = copy.src;
+        SDL_Rect dstrect = copy.dst;
+        if (SDL_RenderCopy(get_raw_(), raw_texture, &srcrect, &dstrect) < 0)
+            warn_sdl() << "Could not render texture";
+    }
+}
+
 void Renderer::prepare(const Texture& texture) const
 {
     texture.get_raw_(*this);
 }
 
+Texture Renderer::create_target(Dims<int> dims, Color color)
+{
+    SDL_Texture* raw = SDL_CreateTexture(get_raw_(),
+                                         SDL_PIXELFORMAT_RGBA8888,
+                                         SDL_TEXTUREACCESS_TARGET,
+                                         dims.width, dims.height);
+    if (!raw)
+        throw Host_error{"Could not create target texture"};
+
+    Texture result(raw);
+    SDL_SetTextureBlendMode(raw, SDL_BLENDMODE_BLEND);
+    set_target(&result);
+    set_color(color);
+    clear();
+    set_target(nullptr);
+    return result;
+}
+
+void Renderer::set_target(const Texture* texture)
+{
+    SDL_Texture* raw = texture ? texture->get_raw_(*this) : nullptr;
+    if (SDL_SetRenderTarget(get_raw_(), raw))
+        throw Host_error{"Could not set render target"};
+}
+
+unsigned long Renderer::targets_lost() const NOEXCEPT
+{
+    return targets_lost_;
+}
+
+void Renderer::note_targets_lost() NOEXCEPT
+{
+    ++targets_lost_;
+}
+
 Texture::Impl_::Impl_(Owned<SDL_Surface> surface) NOEXCEPT
         : surface_(surface)
 { }
@@ -184,6 +346,10 @@ Texture::Texture(Uniq_SDL_Surface surface)
         : impl_(std::make_shared<Impl_>(std::move(surface)))
 { }
 
+Texture::Texture(Owned<SDL_Texture> texture)
+        : impl_(std::make_shared<Impl_>(texture))
+{ }
+
 SDL_Texture* Texture::get_raw_(const Renderer& renderer) const
 {
     if (impl_->texture_) return impl_->texture_.get();
@@ -225,6 +391,11 @@ bool Texture::empty() const NOEXCEPT
     return impl_ == nullptr;
 }
 
+bool Texture::same_as(const Texture& other) const NOEXCEPT
+{
+    return impl_ == other.impl_;
+}
+
 } // end namespace detail
 
 }
@@ -6,16 +6,38 @@
 #include <SDL_image.h>
 #include <SDL_ttf.h>
 
+#include <cerrno>
 #include <clocale>
+#include <cstdlib>
 
 namespace ge211 {
 
 namespace detail {
 
+long offscreen_frames_from_env() NOEXCEPT
+{
+    char const* value = std::getenv("GE211_OFFSCREEN");
+    if (!value) return 0;
+
+    char* end;
+    errno = 0;
+    long frames = std::strtol(value, &end, 10);
+    if (end == value || *end != '\0' || errno == ERANGE || frames <= 0)
+        return -1;
+    return frames;
+}
+
 Sdl_session::Sdl_session()
 {
     SDL_SetMainReady();
 
+    // Running offscreen needs no display or sound device, so unless told
+    // otherwise, use SDL's drivers that need none.
+    if (offscreen_frames_from_env() > 0) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
         fatal_sdl() << "Could not initialize SDL2";
         exit(1);
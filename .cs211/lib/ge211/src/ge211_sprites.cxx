@@ -4,8 +4,11 @@
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_ttf.h>
+#include "utf8.h"
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 
 namespace ge211 {
 
@@ -18,18 +21,73 @@ Sprite_set&
 Sprite_set::add_sprite(const Sprite& sprite, Posn<int> xy, int z,
                        const Transform& t)
 {
-    sprites_.emplace_back(sprite, xy, z, t);
+    layers_.add(sprite, xy, z, t);
     return *this;
 }
 
+// Slot numbers are kept one up in handles, so that 0 can mean none.
+Sprite_set::Handle::Handle() NOEXCEPT
+        : slot_{0}, generation_{0}
+{ }
+
+Sprite_set::Handle::Handle(Sprite_layers::Slot slot) NOEXCEPT
+        : slot_{slot.index + 1}, generation_{slot.generation}
+{ }
+
+Sprite_set::Handle::operator bool() const NOEXCEPT
+{
+    return slot_ != 0;
+}
+
+Sprite_set::Handle
+Sprite_set::retain_sprite(const Sprite& sprite, Posn<int> xy, int z,
+                          const Transform& t)
+{
+    return Handle(layers_.retain(sprite, xy, z, t));
+}
+
+Placed_sprite&
+Sprite_set::retained_(Handle handle, char const* who)
+{
+    Placed_sprite* placed =
+            handle ? layers_.retained({handle.slot_ - 1, handle.generation_})
+                   : nullptr;
+    if (!placed)
+        throw Client_logic_error(std::string("Sprite_set::") + who +
+                                 ": no such retained sprite");
+    return *placed;
+}
+
+Sprite_set&
+Sprite_set::change_sprite(Handle handle, const Sprite& sprite)
+{
+    retained_(handle, "change_sprite").sprite = &sprite;
+    return *this;
+}
+
+Sprite_set&
+Sprite_set::move_sprite(Handle handle, Posn<int> xy)
+{
+    retained_(handle, "move_sprite").xy = xy;
+    return *this;
+}
+
+void
+Sprite_set::release_sprite(Handle& handle)
+{
+    retained_(handle, "release_sprite");
+    layers_.release({handle.slot_ - 1, handle.generation_});
+    handle = Handle();
+}
+
 namespace detail {
 
 Placed_sprite::Placed_sprite(const Sprite& sprite, Posn<int> xy,
-                             int z, const Transform& transform) NOEXCEPT
+                             int z, uint32_t transform) NOEXCEPT
         : sprite{&sprite}, xy{xy}, z{z}, transform{transform}
 { }
 
-void Placed_sprite::render(Renderer& dst) const
+void Placed_sprite::render(Renderer& dst, const Transform& transform) const
 {
     sprite->render(dst, xy, transform);
 }
@@ -39,6 +97,129 @@ bool operator<(const Placed_sprite& s1, const Placed_sprite& s2) NOEXCEPT
     return s1.z > s2.z;
 }
 
+Sprite_layers::Sprite_layers()
+        : transforms_{Transform()},
+          retained_transforms_{Transform()}
+{ }
+
+Sprite_layers::Layer_& Sprite_layers::layer_(int z)
+{
+    if (last_ >= layers_.size() || layers_[last_].z != z) {
+        auto layer = std::lower_bound(
+                layers_.begin(), layers_.end(), z,
+                [](Layer_ const& layer, int z) { return layer.z < z; });
+        if (layer == layers_.end() || layer->z != z)
+            layer = layers_.insert(layer, Layer_{z, {}, 0, {}});
+        last_ = size_t(layer - layers_.begin());
+    }
+
+    return layers_[last_];
+}
+
+void Sprite_layers::add(Sprite const& sprite, Posn<int> xy, int z,
+                        Transform const& transform)
+{
+    uint32_t index = 0;
+    if (!transform.is_identity()) {
+        index = uint32_t(transforms_.size());
+        transforms_.push_back(transform);
+    }
+
+    layer_(z).sprites.emplace_back(sprite, xy, z, index);
+    ++size_;
+}
+
+Sprite_layers::Slot
+Sprite_layers::retain(Sprite const& sprite, Posn<int> xy, int z,
+                      Transform const& transform)
+{
+    uint32_t index = 0;
+    if (!transform.is_identity()) {
+        if (free_transforms_.empty()) {
+            index = uint32_t(retained_transforms_.size());
+            retained_transforms_.push_back(transform);
+        } else {
+            index = free_transforms_.back();
+            free_transforms_.pop_back();
+            retained_transforms_[index] = transform;
+        }
+    }
+
+    uint32_t slot;
+    if (free_slots_.empty()) {
+        slot = uint32_t(slots_.size());
+        slots_.emplace_back(sprite, xy, z, index);
+        generations_.push_back(0);
+    } else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        slots_[slot] = Placed_sprite(sprite, xy, z, index);
+    }
+
+    layer_(z).retained.push_back(slot);
+    ++retained_count_;
+    return {slot, generations_[slot]};
+}
+
+Placed_sprite* Sprite_layers::retained(Slot slot) NOEXCEPT
+{
+    if (slot.index >= slots_.size() ||
+            generations_[slot.index] != slot.generation ||
+            !slots_[slot.index].sprite)
+        return nullptr;
+    return &slots_[slot.index];
+}
+
+void Sprite_layers::release(Slot slot)
+{
+    Placed_sprite& placed = slots_[slot.index];
+    ++generations_[slot.index];
+    if (placed.transform != 0)
+        free_transforms_.push_back(placed.transform);
+    ++layer_(placed.z).released;
+    placed.sprite = nullptr;
+    --retained_count_;
+    any_released_ = true;
+}
+
+size_t Sprite_layers::size() const NOEXCEPT
+{
+    return size_ + retained_count_;
+}
+
+void Sprite_layers::clear()
+{
+    // Take the released slots out of their buckets, so they can be reused.
+    if (any_released_) {
+        for (Layer_& layer : layers_) {
+            if (layer.released == 0) continue;
+            auto is_released = [&](uint32_t slot) {
+                if (slots_[slot].sprite) return false;
+                free_slots_.push_back(slot);
+                return true;
+            };
+            layer.retained.erase(std::remove_if(layer.retained.begin(),
+                                                layer.retained.end(),
+                                                is_released),
+                                 layer.retained.end());
+            layer.released = 0;
+        }
+        any_released_ = false;
+    }
+
+    layers_.erase(std::remove_if(layers_.begin(), layers_.end(),
+                                 [](Layer_ const& layer) {
+                                     return layer.sprites.empty() &&
+                                            layer.retained.empty();
+                                 }),
+                  layers_.end());
+    for (Layer_& layer : layers_)
+        layer.sprites.clear();
+    transforms_.resize(1);
+    last_ = 0;
+    size_ = 0;
+}
+
 Dims<int> Texture_sprite::dimensions() const
 {
     return get_texture_().dimensions();
@@ -59,6 +240,40 @@ void Texture_sprite::prepare(const Renderer& renderer) const
     renderer.prepare(get_texture_());
 }
 
+bool Render_batch::add(Renderer& renderer,
+                       Sprite const& sprite,
+                       Posn<int> xy,
+                       Transform const& transform)
+{
+    // Regions can be scaled in a batch, but not rotated or flipped.
+    Rect<int> src;
+    Texture const* texture = nullptr;
+    if (transform.get_rotation() == 0 &&
+            !transform.get_flip_h() && !transform.get_flip_v())
+        texture = sprite.texture_region_(src);
+    if (!texture) {
+        flush(renderer);
+        return false;
+    }
+
+    if (!texture_.same_as(*texture)) {
+        flush(renderer);
+        texture_ = *texture;
+    }
+    Dims<int> dims{int(src.width * transform.get_scale_x()),
+                   int(src.height * transform.get_scale_y())};
+    copies_.push_back({src, Rect<int>::from_top_left(xy, dims)});
+    return true;
+}
+
+void Render_batch::flush(Renderer& renderer)
+{
+    if (!copies_.empty()) {
+        renderer.copy_batch(texture_, copies_);
+        copies_.clear();
+    }
+}
+
 } // end namespace detail
 
 namespace internal {
@@ -186,10 +401,16 @@ int Circle_sprite::radius_() const
 
 Texture
 Image_sprite::load_texture_(const std::string& filename)
+{
+    return Texture(load_surface_(filename));
+}
+
+SDL_Surface*
+Image_sprite::load_surface_(const std::string& filename)
 {
     File_resource file(filename);
     SDL_Surface* raw = IMG_Load_RW(file.get_raw(), 0);
-    if (raw) return Texture(raw);
+    if (raw) return raw;
 
     throw Image_error::could_not_load(filename);
 }
@@ -348,6 +569,294 @@ void Multiplexed_sprite::render(detail::Renderer& renderer,
     selection.render(renderer, position, transform);
 }
 
+Atlas_sprite::Atlas_sprite(Texture const& texture, Rect<int> src)
+        : texture_(texture), src_(src)
+{ }
+
+Dims<int> Atlas_sprite::dimensions() const
+{
+    return src_.dimensions();
+}
+
+void Atlas_sprite::render(detail::Renderer& renderer,
+                          Posn<int> position,
+                          Transform const& transform) const
+{
+    if (transform.is_identity())
+        renderer.copy(texture_, src_, position);
+    else
+        renderer.copy(texture_, src_, position, transform);
+}
+
+void Atlas_sprite::prepare(detail::Renderer const& renderer) const
+{
+    renderer.prepare(texture_);
+}
+
+Texture const* Atlas_sprite::texture_region_(Rect<int>& src) const
+{
+    src = src_;
+    return &texture_;
+}
+
+// Images are packed left to right into shelves no wider than this, or
+// the widest image, which keeps the atlas well inside the texture size
+// limits of graphics devices.
+static int const atlas_shelf_width = 2048;
+
+Texture Atlas::pack_(std::vector<Uniq_SDL_Surface> const& images,
+                     std::vector<Rect<int>>& places)
+{
+    Dims<int> dims{0, 0};
+    Posn<int> next{0, 0};
+    int shelf_height = 0;
+
+    places.clear();
+    for (Uniq_SDL_Surface const& image : images) {
+        Dims<int> image_dims{image->w, image->h};
+        if (next.x > 0 && next.x + image_dims.width > atlas_shelf_width) {
+            next = {0, next.y + shelf_height};
+            shelf_height = 0;
+        }
+        places.push_back(Rect<int>::from_top_left(next, image_dims));
+        next.x += image_dims.width;
+        shelf_height = std::max(shelf_height, image_dims.height);
+        dims.width = std::max(dims.width, next.x);
+        dims.height = std::max(dims.height, next.y + shelf_height);
+    }
+
+    if (images.empty()) return Texture{};
+
+    SDL_Surface* packed =
+            SDL_CreateRGBSurfaceWithFormat(0, dims.width, dims.height,
+                                           32, SDL_PIXELFORMAT_RGBA32);
+    if (!packed)
+        throw Host_error{"Could not create atlas surface"};
+    Texture result(packed);
+
+    // Copy the pixels as they are, alpha and all, rather than blending.
+    for (size_t i = 0; i < images.size(); ++i) {
+        SDL_Rect dst = places[i];
+        SDL_SetSurfaceBlendMode(images[i].get(), SDL_BLENDMODE_NONE);
+        if (SDL_BlitSurface(images[i].get(), nullptr, packed, &dst) < 0)
+            throw Host_error{"Could not pack image into atlas"};
+    }
+
+    return result;
+}
+
+Atlas::Atlas(std::vector<std::string> const& filenames)
+{
+    std::vector<Uniq_SDL_Surface> images;
+    for (std::string const& filename : filenames)
+        images.emplace_back(Image_sprite::load_surface_(filename));
+
+    std::vector<Rect<int>> places;
+    texture_ = pack_(images, places);
+
+    for (Rect<int> place : places)
+        sprites_.push_back(Atlas_sprite(texture_, place));
+}
+
+size_t Atlas::size() const
+{
+    return sprites_.size();
+}
+
+Atlas_sprite const& Atlas::operator[](size_t i) const
+{
+    return sprites_[i];
+}
+
+Glyph_atlas::Glyph_atlas(Font const& font,
+                         std::string const& characters,
+                         Color color)
+{
+    std::vector<uint32_t> code_points;
+    auto i = characters.begin();
+    while (i != characters.end())
+        code_points.push_back(utf8::next(i, characters.end()));
+    std::sort(code_points.begin(), code_points.end());
+    code_points.erase(std::unique(code_points.begin(), code_points.end()),
+                      code_points.end());
+
+    // Each glyph is rendered on its own, which makes it as wide as the
+    // font moves along for it.
+    std::vector<Uniq_SDL_Surface> images;
+    for (uint32_t code_point : code_points) {
+        std::string glyph;
+        utf8::append(code_point, std::back_inserter(glyph));
+        SDL_Surface* raw = TTF_RenderUTF8_Blended(font.get_raw_(),
+                                                  glyph.c_str(),
+                                                  color.to_sdl_());
+        if (!raw)
+            throw Host_error{"Could not render glyph: “" + glyph + "”"};
+        images.emplace_back(raw);
+        height_ = std::max(height_, raw->h);
+    }
+
+    std::vector<Rect<int>> places;
+    texture_ = Atlas::pack_(images, places);
+
+    for (size_t j = 0; j < code_points.size(); ++j)
+        glyphs_.push_back({code_points[j], places[j]});
+}
+
+bool Glyph_atlas::contains(uint32_t code_point) const NOEXCEPT
+{
+    return find_(code_point) != nullptr;
+}
+
+int Glyph_atlas::height() const NOEXCEPT
+{
+    return height_;
+}
+
+Glyph_atlas::Glyph_ const*
+Glyph_atlas::find_(uint32_t code_point) const NOEXCEPT
+{
+    auto glyph = std::lower_bound(
+            glyphs_.begin(), glyphs_.end(), code_point,
+            [](Glyph_ const& glyph, uint32_t code_point) {
+                return glyph.code_point < code_point;
+            });
+    if (glyph == glyphs_.end() || glyph->code_point != code_point)
+        return nullptr;
+    return &*glyph;
+}
+
+Glyph_text_sprite::Glyph_text_sprite(Glyph_atlas const& atlas,
+                                     std::string const& text)
+        : atlas_(&atlas), dims_{0, atlas.height()}
+{
+    set_text(text);
+}
+
+void Glyph_text_sprite::set_text(std::string const& text)
+{
+    if (text == text_) return;
+
+    std::vector<Rect<int>> glyphs;
+    int width = 0;
+    try {
+        auto i = text.begin();
+        while (i != text.end()) {
+            uint32_t code_point = utf8::next(i, text.end());
+            Glyph_atlas::Glyph_ const* glyph = atlas_->find_(code_point);
+            if (!glyph)
+                throw Client_logic_error(
+                        "Glyph_text_sprite::set_text: no glyph for “" +
+                        text + "”");
+            glyphs.push_back(glyph->src);
+            width += glyph->src.width;
+        }
+    } catch (utf8::exception const&) {
+        throw Client_logic_error(
+                "Glyph_text_sprite::set_text: not valid UTF-8");
+    }
+
+    text_ = text;
+    glyphs_ = std::move(glyphs);
+    dims_ = {width, atlas_->height()};
+}
+
+std::string const& Glyph_text_sprite::text() const NOEXCEPT
+{
+    return text_;
+}
+
+Dims<int> Glyph_text_sprite::dimensions() const
+{
+    return dims_;
+}
+
+void Glyph_text_sprite::render(detail::Renderer& renderer,
+                               Posn<int> position,
+                               Transform const& transform) const
+{
+    if (glyphs_.empty()) return;
+
+    double scale_x = transform.get_scale_x();
+    double scale_y = transform.get_scale_y();
+    copies_.clear();
+    int x = 0;
+    for (Rect<int> src : glyphs_) {
+        Posn<int> xy{position.x + int(x * scale_x), position.y};
+        Dims<int> dims{int(src.width * scale_x), int(src.height * scale_y)};
+        copies_.push_back({src, Rect<int>::from_top_left(xy, dims)});
+        x += src.width;
+    }
+    renderer.copy_batch(atlas_->texture_, copies_);
+}
+
+void Glyph_text_sprite::prepare(detail::Renderer const& renderer) const
+{
+    if (!atlas_->texture_.empty())
+        renderer.prepare(atlas_->texture_);
+}
+
+Canvas_sprite::Canvas_sprite(Dims<int> dims, Color color)
+        : dims_(dims), color_(color)
+{ }
+
+Dims<int> Canvas_sprite::dimensions() const
+{
+    return dims_;
+}
+
+void Canvas_sprite::draw(Sprite const& sprite,
+                         Posn<int> xy,
+                         Transform const& transform)
+{
+    stamps_.push_back({&sprite, xy, transform});
+}
+
+void Canvas_sprite::clear()
+{
+    stamps_.clear();
+    cleared_ = true;
+}
+
+bool Canvas_sprite::check_lost()
+{
+    bool result = lost_;
+    lost_ = false;
+    return result;
+}
+
+void Canvas_sprite::render(detail::Renderer& renderer,
+                           Posn<int> position,
+                           Transform const& transform) const
+{
+    if (texture_.empty() || targets_lost_ != renderer.targets_lost()) {
+        lost_ = !texture_.empty();
+        texture_ = renderer.create_target(dims_, color_);
+        targets_lost_ = renderer.targets_lost();
+    }
+
+    if (cleared_ || !stamps_.empty()) {
+        renderer.set_target(&texture_);
+        if (cleared_) {
+            renderer.set_color(color_);
+            renderer.clear();
+            cleared_ = false;
+        }
+        for (Stamp_ const& stamp : stamps_) {
+            if (!batch_.add(renderer, *stamp.sprite, stamp.xy,
+                            stamp.transform))
+                stamp.sprite->render(renderer, stamp.xy, stamp.transform);
+        }
+        batch_.flush(renderer);
+        renderer.set_target(nullptr);
+        stamps_.clear();
+    }
+
+    if (transform.is_identity())
+        renderer.copy(texture_, position);
+    else
+        renderer.copy(texture_, position, transform);
+}
+
 } // end namespace sprites
 
 }
@@ -7,13 +7,13 @@ namespace ge211 {
 
 using namespace detail;
 
-Window::Window(const std::string& title, Dims<int> dim)
+Window::Window(const std::string& title, Dims<int> dim, bool shown)
         : ptr_{SDL_CreateWindow(title.c_str(),
                                 SDL_WINDOWPOS_UNDEFINED,
                                 SDL_WINDOWPOS_UNDEFINED,
                                 dim.width,
                                 dim.height,
-                                SDL_WINDOW_SHOWN)}
+                                shown? SDL_WINDOW_SHOWN : SDL_WINDOW_HIDDEN)}
 {
     if (!ptr_)
         throw Host_error{"Could not create window"};
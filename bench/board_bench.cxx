@@ -0,0 +1,318 @@
+// Benchmarks for the Board engine. Build with optimizations turned on, e.g.
+// `cmake -DCMAKE_BUILD_TYPE=Release`, and run `board_bench` from the build
+// directory.
+
+#include "board.hxx"
+#include "mine_placement.hxx"
+#include "no_guess.hxx"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// The fraction of cells holding a mine on an expert board (99 / 480).
+static double const expert_density = 0.206;
+
+// Returns the number of milliseconds since start.
+static double
+ms_since(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count();
+}
+
+// Replaces the mines on board with a reproducible expert-density layout.
+static void
+place_expert_mines(Board& board)
+{
+    Rng gen(211);
+    std::bernoulli_distribution is_mine(expert_density);
+
+    board.clear_mines_on_board();
+    board.begin_bulk_edit();
+    Board::Dimensions dims = board.dimensions();
+    for (int y = 0; y < dims.height; y++)
+    {
+        for (int x = 0; x < dims.width; x++)
+        {
+            if (is_mine(gen))
+            {
+                board.set_mine({x, y}, true);
+            }
+        }
+    }
+    board.end_bulk_edit();
+}
+
+// Times revealing every non-mine cell of an expert-density board, which
+// floods every opening on the board once.
+static void
+bench_flood_reveal(Board::Dimensions dims)
+{
+    Board board(dims);
+    place_expert_mines(board);
+
+    // The reveal returns true exactly for the mines, which stay covered.
+    Clock::time_point start = Clock::now();
+    for (int y = 0; y < dims.height; y++)
+    {
+        for (int x = 0; x < dims.width; x++)
+        {
+            board.reveal({x, y});
+        }
+    }
+    double reveal_ms = ms_since(start);
+
+    start = Clock::now();
+    bool won = board.win();
+    double win_ms = ms_since(start);
+
+    std::cout << std::setw(12) << dims.width << "x" << std::left
+              << std::setw(8) << dims.height << std::right
+              << std::setw(14) << reveal_ms
+              << std::setw(14) << win_ms
+              << (won ? "" : "  (not won!)") << "\n";
+}
+
+// Times revealing a completely empty board with a single click, which is
+// the worst case for the flood fill: one opening covering every cell.
+static void
+bench_empty_opening(Board::Dimensions dims)
+{
+    Board board(dims);
+    board.clear_mines_on_board();
+
+    Clock::time_point start = Clock::now();
+    board.reveal({dims.width / 2, dims.height / 2});
+    double reveal_ms = ms_since(start);
+
+    std::cout << std::setw(12) << dims.width << "x" << std::left
+              << std::setw(8) << dims.height << std::right
+              << std::setw(14) << reveal_ms
+              << (board.win() ? "" : "  (not won!)") << "\n";
+}
+
+// Times recounting the adjacent mines of every cell on an expert-density
+// board with one of the adjacency engines.
+static double
+time_adjacency(Board& board, Board::Adjacency_engine engine)
+{
+    board.set_adjacency_engine(engine);
+    Clock::time_point start = Clock::now();
+    board.guarantee_adjacent_mines();
+    return ms_since(start);
+}
+
+static void
+bench_adjacency(Board::Dimensions dims)
+{
+    Board board(dims);
+    place_expert_mines(board);
+
+    double scalar_ms = time_adjacency(board,
+                                      Board::Adjacency_engine::scalar);
+    double bitboard_ms = time_adjacency(board,
+                                        Board::Adjacency_engine::bitboard);
+
+    std::cout << std::setw(12) << dims.width << "x" << std::left
+              << std::setw(8) << dims.height << std::right
+              << std::setw(14) << scalar_ms
+              << std::setw(14) << bitboard_ms << "\n";
+}
+
+// Times toggling a thousand random mines on an expert-density board, one
+// set_mine at a time and as one bulk edit.
+static void
+bench_edit(Board::Dimensions dims)
+{
+    Board board(dims);
+    place_expert_mines(board);
+    Rng rng(211);
+    std::vector<Board::Position> edits;
+    for (int k = 0; k < 1000; k++)
+    {
+        edits.push_back({rng(0, dims.width - 1), rng(0, dims.height - 1)});
+    }
+
+    Clock::time_point start = Clock::now();
+    for (Board::Position pos : edits)
+    {
+        board.set_mine(pos, ! board.get_board()[pos].is_mine());
+    }
+    double one_at_a_time_ms = ms_since(start);
+
+    start = Clock::now();
+    board.begin_bulk_edit();
+    for (Board::Position pos : edits)
+    {
+        board.set_mine(pos, ! board.get_board()[pos].is_mine());
+    }
+    board.end_bulk_edit();
+    double bulk_ms = ms_since(start);
+
+    std::cout << std::setw(12) << dims.width << "x" << std::left
+              << std::setw(8) << dims.height << std::right
+              << std::setw(14) << one_at_a_time_ms
+              << std::setw(14) << bulk_ms << "\n";
+}
+
+// Times choose_mine_cells with one method on boards of the given size and
+// density, and returns how many boards it placed per second.
+static double
+boards_per_second(Board::Dimensions dims, double density,
+                  Placement_method method)
+{
+    Rng random(211);
+    int cells = dims.width * dims.height;
+    int mines = int(cells * density);
+
+    // Keep going for at least 200 ms so small boards time accurately.
+    long boards = 0;
+    size_t checksum = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed_ms;
+    do
+    {
+        checksum += choose_mine_cells(cells, mines, random, method).size();
+        boards++;
+        elapsed_ms = ms_since(start);
+    } while (elapsed_ms < 200);
+
+    if (checksum != size_t(boards) * mines)
+    {
+        std::cout << "(wrong number of mines!) ";
+    }
+    return boards * 1000 / elapsed_ms;
+}
+
+static void
+bench_placement(Board::Dimensions dims, double density)
+{
+    std::cout << std::setw(12) << dims.width << "x" << std::left
+              << std::setw(8) << dims.height << std::right
+              << std::setw(8) << std::setprecision(3) << density
+              << std::setprecision(0);
+    for (Placement_method method : {Placement_method::fisher_yates,
+                                    Placement_method::floyd,
+                                    Placement_method::rejection,
+                                    Placement_method::automatic})
+    {
+        std::cout << std::setw(14) << boards_per_second(dims, density, method);
+    }
+    std::cout << std::setprecision(3) << "\n";
+}
+
+// Times finding boards that can be solved without guessing from a click in
+// the middle, checking candidates on the given number of threads.
+static void
+bench_no_guess(char const* name, Game_config const& config, int threads,
+               int boards)
+{
+    No_guess_generator generator(threads);
+    Board::Position middle{config.dims.width / 2, config.dims.height / 2};
+    int64_t checked = 0;
+    int failed = 0;
+    Clock::time_point start = Clock::now();
+    for (int board = 0; board < boards; board++)
+    {
+        failed += generator.find(config, middle, uint64_t(board)) < 0;
+        checked += generator.candidates_checked();
+    }
+    double elapsed_ms = ms_since(start);
+
+    std::cout << std::setw(21) << name
+              << std::setw(8) << threads
+              << std::setw(14) << std::setprecision(0)
+              << boards * 1000 / elapsed_ms
+              << std::setw(14) << std::setprecision(1)
+              << double(checked) / boards
+              << std::setprecision(3)
+              << (failed ? "  (some boards not found!)" : "") << "\n";
+}
+
+int
+main()
+{
+    std::cout << std::fixed << std::setprecision(3)
+              << std::setw(21) << "board"
+              << std::setw(14) << "reveal ms"
+              << std::setw(14) << "win() ms" << "\n";
+
+    for (Board::Dimensions dims : {Board::Dimensions{30, 16},
+                                   Board::Dimensions{256, 256},
+                                   Board::Dimensions{1024, 1024},
+                                   Board::Dimensions{4096, 4096}})
+    {
+        bench_flood_reveal(dims);
+    }
+
+    std::cout << "\n" << std::setw(21) << "empty board"
+              << std::setw(14) << "click ms" << "\n";
+
+    for (Board::Dimensions dims : {Board::Dimensions{1024, 1024},
+                                   Board::Dimensions{4096, 4096},
+                                   Board::Dimensions{10000, 10000}})
+    {
+        bench_empty_opening(dims);
+    }
+
+    const char* simd_names[] = {"none", "SSE2", "AVX2"};
+    std::cout << "\n" << std::setw(21) << "recount"
+              << std::setw(14) << "scalar ms"
+              << std::setw(14) << "bitboard ms"
+              << "  (SIMD: "
+              << simd_names[int(Mine_bitboard::best_simd())] << ")\n";
+
+    for (Board::Dimensions dims : {Board::Dimensions{30, 16},
+                                   Board::Dimensions{1024, 1024},
+                                   Board::Dimensions{4096, 4096}})
+    {
+        bench_adjacency(dims);
+    }
+
+    std::cout << "\n" << std::setw(21) << "1000 edits"
+              << std::setw(14) << "set_mine ms"
+              << std::setw(14) << "bulk ms" << "\n";
+
+    for (Board::Dimensions dims : {Board::Dimensions{30, 16},
+                                   Board::Dimensions{1024, 1024},
+                                   Board::Dimensions{4096, 4096}})
+    {
+        bench_edit(dims);
+    }
+
+    std::cout << "\n" << std::setw(21) << "placement"
+              << std::setw(8) << "density"
+              << std::setw(14) << "shuffle/s"
+              << std::setw(14) << "floyd/s"
+              << std::setw(14) << "rejection/s"
+              << std::setw(14) << "automatic/s" << "\n";
+
+    for (Board::Dimensions dims : {Board::Dimensions{30, 16},
+                                   Board::Dimensions{1024, 1024}})
+    {
+        for (double density : {0.01, expert_density, 0.5, 0.9})
+        {
+            bench_placement(dims, density);
+        }
+    }
+
+    std::cout << "\n" << std::setw(21) << "no-guess"
+              << std::setw(8) << "threads"
+              << std::setw(14) << "boards/s"
+              << std::setw(14) << "candidates" << "\n";
+
+    for (int threads : {1, 2, 4, 8})
+    {
+        bench_no_guess("beginner", Game_config::beginner(), threads, 2000);
+        bench_no_guess("intermediate", Game_config::intermediate(), threads,
+                       1000);
+        bench_no_guess("expert", Game_config::expert(), threads, 200);
+    }
+
+    return 0;
+}
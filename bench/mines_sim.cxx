@@ -0,0 +1,156 @@
+// Plays many games of Minesweeper without opening a window, and reports how
+// fast the Model plays them. Build with optimizations turned on, e.g.
+// `cmake -DCMAKE_BUILD_TYPE=Release`, and run
+//
+//     mines_sim [--games N] [--seed N] [--policy random|sweep|solver]
+//               [--threads N] [--scaling]
+//               [--first-click anything|safe|opening] [--no-guess]
+//               [beginner | intermediate | expert | WIDTH HEIGHT MINES]
+//
+// from the build directory. The games are spread over every core unless
+// --threads says otherwise; --scaling plays them again with 1, 2, 4, ...
+// threads to show how the speed scales. The results are the same for any
+// number of threads. --first-click says what the first click is sure to
+// uncover (anything, unless it says otherwise), and --no-guess plays boards
+// that can be solved without guessing from the first click.
+
+#include "simulation.hxx"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static void
+usage(char const* program)
+{
+    std::cerr << "Usage: " << program
+              << " [--games N] [--seed N] [--policy random|sweep|solver]"
+              << " [--threads N] [--scaling]"
+              << " [--first-click anything|safe|opening] [--no-guess]"
+              << " [beginner | intermediate | expert | WIDTH HEIGHT MINES]\n";
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint64_t games = 10000;
+    uint64_t seed = 211;
+    char const* policy_name = "random";
+    int threads = std::max(1, int(std::thread::hardware_concurrency()));
+    bool scaling = false;
+    bool no_guess = false;
+    bool good_options = true;
+    Game_config::First_click first_click = Game_config::First_click::anything;
+    std::vector<char const*> args;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--games") == 0 && has_value)
+        {
+            games = std::strtoull(argv[++i], nullptr, 0);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && has_value)
+        {
+            seed = std::strtoull(argv[++i], nullptr, 0);
+        }
+        else if (std::strcmp(argv[i], "--policy") == 0 && has_value)
+        {
+            policy_name = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && has_value)
+        {
+            threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--scaling") == 0)
+        {
+            scaling = true;
+        }
+        else if (std::strcmp(argv[i], "--first-click") == 0 && has_value)
+        {
+            good_options = good_options &&
+                           Game_config::parse_first_click(argv[++i],
+                                                          first_click);
+        }
+        else if (std::strcmp(argv[i], "--no-guess") == 0)
+        {
+            no_guess = true;
+        }
+        else
+        {
+            args.push_back(argv[i]);
+        }
+    }
+
+    Game_config config;
+    Click_policy_factory make_policy = [=](uint64_t policy_seed) {
+        return make_click_policy(policy_name, policy_seed);
+    };
+    if (! good_options || ! Game_config::parse(args, config) ||
+        ! make_policy(0))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    config.first_click = first_click;
+    config.no_guess = no_guess;
+
+    if (scaling)
+    {
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(8) << "threads"
+                  << std::setw(14) << "games/sec"
+                  << std::setw(10) << "speedup" << "\n";
+        double one_thread = 0;
+        for (int t = 1; ; t = std::min(2 * t, threads))
+        {
+            Sim_stats stats =
+                    simulate_parallel(config, games, t, make_policy, seed);
+            double rate = stats.games / stats.seconds;
+            if (t == 1)
+            {
+                one_thread = rate;
+            }
+            std::cout << std::setw(8) << t
+                      << std::setw(14) << rate
+                      << std::setw(9) << rate / one_thread << "x\n";
+            if (t == threads)
+            {
+                break;
+            }
+        }
+        std::cout << "\n";
+    }
+
+    Sim_stats stats =
+            simulate_parallel(config, games, threads, make_policy, seed);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << config.dims.width << "x" << config.dims.height << " with "
+              << config.mines << " mines, "
+              << (no_guess ? "no guessing, " : "")
+              << policy_name << " policy, seed "
+              << seed << ", " << threads << " threads\n"
+              << "games:        " << stats.games << " in "
+              << std::setprecision(3) << stats.seconds << " s\n"
+              << std::setprecision(1)
+              << "games/sec:    " << stats.games / stats.seconds << "\n"
+              << "clicks/sec:   " << stats.clicks / stats.seconds << "\n"
+              << "win rate:     "
+              << 100.0 * stats.wins / std::max(stats.games, uint64_t(1))
+              << "%\n";
+    if (stats.stalls)
+    {
+        std::cout << "stalled:      " << stats.stalls << "\n";
+    }
+    std::cout << "reveal ns:    p50 " << stats.reveal_ns.percentile(50)
+              << "  p90 " << stats.reveal_ns.percentile(90)
+              << "  p99 " << stats.reveal_ns.percentile(99)
+              << "  p99.9 " << stats.reveal_ns.percentile(99.9)
+              << "  max " << stats.reveal_ns.max() << "\n";
+
+    return 0;
+}
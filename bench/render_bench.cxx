@@ -0,0 +1,148 @@
+// Benchmarks for drawing the game, rendering included: View::draw, and the
+// game engine painting the sprites it adds, for a few board sizes while
+// different things happen on the board. The frames are rendered offscreen
+// with SDL's software renderer, so the paint times are for the CPU rather
+// than a graphics card, but they show how the work grows. Build with
+// optimizations turned on, e.g. `cmake -DCMAKE_BUILD_TYPE=Release`, and run
+// `render_bench` from the build directory. Where there's no display, run it
+// as `GE211_OFFSCREEN=1 ./render_bench`.
+
+#include "view.hxx"
+
+#include <ge211.hxx>
+
+#include <iomanip>
+#include <iostream>
+
+// The number of frames to time in each case, and how many of those to
+// leave out at the start, when every tile is drawn the first time.
+static long const frames = 300;
+static long const warm_up_frames = 10;
+
+// What happens on the board each frame.
+enum class Action
+{
+    nothing, reveal, scroll,
+};
+
+// A game that just shows a board, doing `action` to it each frame.
+class Bench_game : public ge211::Abstract_game
+{
+public:
+    Bench_game(Model::Dimensions dims, Action action)
+            : rng_(211),
+              model_(Game_config::with_density(dims, 99.0 / 480), rng_),
+              view_(model_),
+              action_(action),
+              frame_(0)
+    {
+        record_frame_timing(size_t(frames));
+    }
+
+    // Returns the mean times of the phases of the last `count` frames.
+    ge211::Frame_record mean_frame(long count) const
+    {
+        return get_frame_timing()->recent_mean(size_t(count));
+    }
+
+protected:
+    void draw(ge211::Sprite_set& set) override
+    {
+        view_.draw(set);
+    }
+
+    View::Dimensions initial_window_dimensions() const override
+    {
+        return view_.initial_window_dimensions();
+    }
+
+    void on_frame(double) override
+    {
+        frame_++;
+        if (action_ == Action::reveal)
+        {
+            reveal_safe_cell();
+        }
+        else if (action_ == Action::scroll)
+        {
+            // Back and forth, so it doesn't stop at the edge.
+            int step = frame_ / 100 % 2 == 0 ? 8 : -8;
+            view_.scroll_by({step, step / 2});
+        }
+    }
+
+private:
+    Rng rng_;
+    Model model_;
+    View view_;
+    Action action_;
+    long frame_;
+
+    // Reveals a random covered cell without a mine, if one turns up after
+    // a few tries.
+    void reveal_safe_cell()
+    {
+        Model::Dimensions dims = model_.get_board_dimensions();
+        for (int tries = 0; tries < 1000; tries++)
+        {
+            Model::Position pos{rng_(0, dims.width - 1),
+                                rng_(0, dims.height - 1)};
+            Cell const& cell = model_.get_board()[pos];
+            if (cell.is_covered() && ! cell.is_mine() && ! cell.is_flagged())
+            {
+                model_.reveal(pos);
+                return;
+            }
+        }
+    }
+};
+
+// Runs a game offscreen and prints the mean time of each phase of its
+// frames that has to do with drawing, in milliseconds.
+static void
+bench_render(char const* name, Model::Dimensions dims, Action action)
+{
+    Bench_game game(dims, action);
+    game.run_offscreen(frames);
+
+    ge211::Frame_record mean = game.mean_frame(frames - warm_up_frames);
+    double draw_ms = 1000 * mean.phase(ge211::Frame_phase::draw).seconds();
+    double paint_ms = 1000 * mean.phase(ge211::Frame_phase::paint).seconds();
+    double present_ms =
+            1000 * mean.phase(ge211::Frame_phase::present).seconds();
+    double total_ms = 1000 * mean.total().seconds();
+
+    std::cout << std::setw(8) << dims.width << "x" << std::left
+              << std::setw(8) << dims.height << std::right
+              << std::setw(10) << name
+              << std::setw(10) << draw_ms
+              << std::setw(10) << paint_ms
+              << std::setw(10) << present_ms
+              << std::setw(10) << total_ms
+              << std::setw(10) << long(total_ms > 0 ? 1000 / total_ms : 0)
+              << "\n";
+}
+
+int
+main()
+{
+    std::cout << std::fixed << std::setprecision(3)
+              << std::setw(17) << "board"
+              << std::setw(10) << "action"
+              << std::setw(10) << "draw ms"
+              << std::setw(10) << "paint ms"
+              << std::setw(10) << "present"
+              << std::setw(10) << "frame ms"
+              << std::setw(10) << "fps" << "\n";
+
+    for (Model::Dimensions dims : {Model::Dimensions{30, 16},
+                                   Model::Dimensions{100, 100},
+                                   Model::Dimensions{1000, 1000}})
+    {
+        bench_render("nothing", dims, Action::nothing);
+        bench_render("reveal", dims, Action::reveal);
+        bench_render("scroll", dims, Action::scroll);
+    }
+
+    return 0;
+}
@@ -0,0 +1,189 @@
+// Benchmarks for the Solver. Build with optimizations turned on, e.g.
+// `cmake -DCMAKE_BUILD_TYPE=Release`, and run `solver_bench` from the build
+// directory.
+
+#include "probability.hxx"
+#include "simulation.hxx"
+#include "solver.hxx"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using Clock = std::chrono::steady_clock;
+
+// Returns the number of milliseconds since start.
+static double
+ms_since(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count();
+}
+
+// Opens up every opening on an expert-density board, which leaves a
+// frontier running all over it, and times solving that frontier from
+// scratch.
+static void
+bench_frontier(Board::Dimensions dims)
+{
+    Rng rng(211);
+    Board board(Game_config::with_density(dims, 99.0 / 480), rng);
+    for (auto p : board.get_board())
+    {
+        if (! p.second.is_mine() && p.second.get_adjacent_mines() == 0)
+        {
+            board.reveal(p.first);
+        }
+    }
+
+    Solver solver(dims);
+    Clock::time_point start = Clock::now();
+    solver.observe_all(board.get_board());
+    double observe_ms = ms_since(start);
+    start = Clock::now();
+    solver.deduce();
+    double deduce_ms = ms_since(start);
+
+    int safe = 0;
+    int mines = 0;
+    int wrong = 0;
+    Board::Position pos{0, 0};
+    while (solver.next_safe(pos))
+    {
+        safe++;
+        wrong += board.get_board()[pos].is_mine();
+    }
+    while (solver.next_mine(pos))
+    {
+        mines++;
+        wrong += ! board.get_board()[pos].is_mine();
+    }
+
+    std::cout << std::setw(12) << dims.width << "x" << std::left
+              << std::setw(8) << dims.height << std::right
+              << std::setw(12) << solver.frontier_size()
+              << std::setw(12) << observe_ms
+              << std::setw(12) << deduce_ms
+              << std::setw(10) << safe
+              << std::setw(10) << mines
+              << (wrong ? "  (wrong deductions!)" : "") << "\n";
+}
+
+// Times the solver playing whole games by itself.
+static void
+bench_auto_play(char const* name, Game_config const& config, uint64_t games)
+{
+    Click_policy_factory make_solver = [](uint64_t seed) {
+        return make_click_policy("solver", seed);
+    };
+    Sim_stats stats = simulate_parallel(config, games, 1, make_solver, 211);
+
+    std::cout << std::setw(21) << name
+              << std::setw(12) << stats.games / stats.seconds
+              << std::setw(11) << 100.0 * stats.wins / stats.games << "%"
+              << std::setw(12) << double(stats.clicks) / stats.games
+              << "\n";
+}
+
+// Plays an expert-density board with the solver from a few openings until
+// it's stuck and would have to guess, then times working out the chance of
+// a mine in every cell of that position.
+static void
+bench_probability(Board::Dimensions dims, int threads)
+{
+    Rng rng(211);
+    Game_config config = Game_config::with_density(dims, 99.0 / 480);
+    Board board(config, rng);
+    Board::Cell_view view = board.get_board();
+    Solver solver(dims);
+    int openings = 0;
+    for (auto p : view)
+    {
+        if (! p.second.is_mine() && p.second.get_adjacent_mines() == 0 &&
+            p.second.is_covered() && rng(0, 15) == 0)
+        {
+            board.reveal(p.first);
+            openings++;
+        }
+    }
+    solver.observe_all(view);
+    solver.deduce();
+    Board::Position pos{0, 0};
+    for (bool more = true; more; )
+    {
+        more = false;
+        while (solver.next_safe(pos))
+        {
+            board.reveal(pos);
+            solver.observe(view, pos);
+            more = true;
+        }
+        solver.deduce();
+    }
+
+    Probability_engine engine(threads);
+    Probability_grid grid;
+    Clock::time_point start = Clock::now();
+    bool ok = engine.compute(view, config.mines, grid);
+    double ms = ms_since(start);
+
+    Probability_engine::Info const& info = engine.info();
+    std::cout << std::setw(12) << dims.width << "x" << std::left
+              << std::setw(8) << dims.height << std::right
+              << std::setw(8) << threads
+              << std::setw(10) << info.frontier_cells
+              << std::setw(12) << info.components
+              << std::setw(10) << info.largest_component
+              << std::setw(8) << info.widest_state
+              << std::setw(12) << ms
+              << (ok ? "" : "  (no arrangement fits!)") << "\n";
+}
+
+int
+main()
+{
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(21) << "frontier"
+              << std::setw(12) << "cells"
+              << std::setw(12) << "observe ms"
+              << std::setw(12) << "deduce ms"
+              << std::setw(10) << "safe"
+              << std::setw(10) << "mines" << "\n";
+
+    for (Board::Dimensions dims : {Board::Dimensions{30, 16},
+                                   Board::Dimensions{256, 256},
+                                   Board::Dimensions{1000, 1000}})
+    {
+        bench_frontier(dims);
+    }
+
+    std::cout << "\n" << std::setw(21) << "auto-play"
+              << std::setw(12) << "games/sec"
+              << std::setw(12) << "win rate"
+              << std::setw(12) << "clicks" << "\n";
+
+    bench_auto_play("beginner", Game_config::beginner(), 20000);
+    bench_auto_play("intermediate", Game_config::intermediate(), 5000);
+    bench_auto_play("expert", Game_config::expert(), 2000);
+    bench_auto_play("1000x1000 expert",
+                    Game_config::with_density({1000, 1000}, 99.0 / 480), 2);
+
+
+    std::cout << "\n" << std::setw(21) << "probability"
+              << std::setw(8) << "threads"
+              << std::setw(10) << "frontier"
+              << std::setw(12) << "components"
+              << std::setw(10) << "largest"
+              << std::setw(8) << "width"
+              << std::setw(12) << "ms" << "\n";
+
+    for (Board::Dimensions dims : {Board::Dimensions{30, 16},
+                                   Board::Dimensions{100, 100},
+                                   Board::Dimensions{256, 256}})
+    {
+        bench_probability(dims, 1);
+        bench_probability(dims, 4);
+    }
+
+    return 0;
+}
@@ -0,0 +1,232 @@
+// Benchmarks for putting a frame's sprites in z order, as the game engine
+// does before rendering them, and for keeping them from frame to frame
+// instead of adding them all again. Build with optimizations turned on, e.g.
+// `cmake -DCMAKE_BUILD_TYPE=Release`, and run `sprite_bench` from the build
+// directory. It needs no window, since it leaves out rendering.
+
+#include <ge211.hxx>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using ge211::detail::Placed_sprite;
+
+// The number of frames to time for each case.
+static int const frames = 200;
+
+// Returns the number of microseconds since start.
+static double
+us_since(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start)
+            .count();
+}
+
+// A sprite that draws nothing, since only the ordering is being timed.
+class Null_sprite : public ge211::Sprite
+{
+public:
+    ge211::Dims<int> dimensions() const override
+    {
+        return {1, 1};
+    }
+
+private:
+    void render(ge211::detail::Renderer&, ge211::Posn<int>,
+                ge211::Transform const&) const override
+    { }
+};
+
+// What visiting the sprites of a frame in order found: a checksum, so the
+// work can't be skipped, and the number of pairs of sprites at the same z
+// that came out in a different order than they went in.
+struct Visit
+{
+    long checksum = 0;
+    long out_of_order = 0;
+    Placed_sprite const* last = nullptr;
+
+    void operator()(Placed_sprite const& placed)
+    {
+        checksum += placed.xy.x + placed.z;
+        if (last && last->z == placed.z && last->xy.x > placed.xy.x)
+        {
+            out_of_order++;
+        }
+        last = &placed;
+    }
+};
+
+// Makes the sprites of a frame. Each one's x coordinate is the order it
+// was added in. With `board`, nearly all of them are tiles at z 1, with a
+// background below and a few counters above, as View draws them;
+// otherwise their z is spread over ten layers at random.
+static std::vector<Placed_sprite>
+make_frame(Null_sprite const& sprite, int count, bool board)
+{
+    ge211::Random_source<int> random_z(0, 9);
+    std::vector<Placed_sprite> result;
+    for (int i = 0; i < count; i++)
+    {
+        int z = board ? (i == 0 ? 0 : i % 1000 == 999 ? 3 : 1) : random_z();
+        result.emplace_back(sprite, ge211::Posn<int>{i, 0}, z);
+    }
+    return result;
+}
+
+// Times ordering one frame's sprites both ways: with a heap, as the engine
+// used to, and with a Sprite_layers, as it does now.
+static void
+bench_order(char const* name, int count, bool board)
+{
+    Null_sprite sprite;
+    std::vector<Placed_sprite> frame = make_frame(sprite, count, board);
+
+    // The old way: make a heap and pop the sprites off it, back to front.
+    std::vector<Placed_sprite> heap;
+    Visit heap_visit;
+    Clock::time_point start = Clock::now();
+    for (int f = 0; f < frames; f++)
+    {
+        for (Placed_sprite const& placed : frame)
+        {
+            heap.push_back(placed);
+        }
+        std::make_heap(heap.begin(), heap.end());
+        heap_visit.last = nullptr;
+        for (auto end = heap.end(); end != heap.begin(); )
+        {
+            std::pop_heap(heap.begin(), end--);
+            heap_visit(*end);
+        }
+        heap.clear();
+    }
+    double heap_us = us_since(start) / frames;
+
+    // The new way: drop them into buckets, which are already in order.
+    ge211::detail::Sprite_layers layers;
+    ge211::Transform identity;
+    Visit layers_visit;
+    start = Clock::now();
+    for (int f = 0; f < frames; f++)
+    {
+        for (Placed_sprite const& placed : frame)
+        {
+            layers.add(*placed.sprite, placed.xy, placed.z, identity);
+        }
+        layers_visit.last = nullptr;
+        layers.for_each([&](Placed_sprite const& placed,
+                            ge211::Transform const&) {
+            layers_visit(placed);
+        });
+        layers.clear();
+    }
+    double layers_us = us_since(start) / frames;
+
+    std::cout << std::setw(16) << name
+              << std::setw(10) << count
+              << std::setw(12) << heap_us
+              << std::setw(12) << layers_us
+              << std::setw(10) << heap_us / layers_us
+              << std::setw(14) << heap_visit.out_of_order / frames
+              << std::setw(14) << layers_visit.out_of_order / frames
+              << (heap_visit.checksum == layers_visit.checksum
+                  ? "" : "  (different sprites!)") << "\n";
+}
+
+// Times a frame of a board with `count` tiles, of which `changed` change
+// picture each frame: adding every tile each frame, and retaining them
+// once and changing just the ones whose picture changed.
+static void
+bench_retained(int count, int changed)
+{
+    Null_sprite covered, uncovered;
+    ge211::Transform identity;
+    std::vector<Placed_sprite> frame = make_frame(covered, count, true);
+
+    ge211::detail::Sprite_layers added;
+    Visit added_visit;
+    Clock::time_point start = Clock::now();
+    for (int f = 0; f < frames; f++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            Null_sprite const& sprite =
+                    i < (f + 1) * changed ? uncovered : covered;
+            added.add(sprite, frame[i].xy, frame[i].z, identity);
+        }
+        added.for_each([&](Placed_sprite const& placed,
+                           ge211::Transform const&) {
+            added_visit(placed);
+        });
+        added.clear();
+    }
+    double added_us = us_since(start) / frames;
+
+    ge211::detail::Sprite_layers retained;
+    std::vector<ge211::detail::Sprite_layers::Slot> slots;
+    for (Placed_sprite const& placed : frame)
+    {
+        slots.push_back(retained.retain(covered, placed.xy, placed.z,
+                                        identity));
+    }
+    Visit retained_visit;
+    start = Clock::now();
+    for (int f = 0; f < frames; f++)
+    {
+        for (int i = f * changed; i < (f + 1) * changed && i < count; i++)
+        {
+            retained.retained(slots[i])->sprite = &uncovered;
+        }
+        retained.for_each([&](Placed_sprite const& placed,
+                              ge211::Transform const&) {
+            retained_visit(placed);
+        });
+        retained.clear();
+    }
+    double retained_us = us_since(start) / frames;
+
+    std::cout << std::setw(16) << "retained board"
+              << std::setw(10) << count
+              << std::setw(12) << added_us
+              << std::setw(12) << retained_us
+              << std::setw(10) << added_us / retained_us
+              << (added_visit.checksum == retained_visit.checksum
+                  ? "" : "  (different sprites!)") << "\n";
+}
+
+int
+main()
+{
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(16) << "us per frame"
+              << std::setw(10) << "sprites"
+              << std::setw(12) << "heap"
+              << std::setw(12) << "layers"
+              << std::setw(10) << "speedup"
+              << std::setw(14) << "heap unstable"
+              << std::setw(14) << "layers unst." << "\n";
+
+    for (int count : {1000, 10000, 100000})
+    {
+        bench_order("board", count, true);
+        bench_order("random z", count, false);
+    }
+
+    std::cout << "\n" << std::setw(16) << "us per frame"
+              << std::setw(10) << "sprites"
+              << std::setw(12) << "added"
+              << std::setw(12) << "retained"
+              << std::setw(10) << "speedup" << "\n";
+    for (int count : {10000, 100000, 500000})
+    {
+        bench_retained(count, 16);
+    }
+    std::cout << "bytes per sprite: " << sizeof(Placed_sprite) << "\n";
+
+    return 0;
+}
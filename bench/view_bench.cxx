@@ -0,0 +1,257 @@
+// Benchmarks for the work View::draw does on the CPU each frame to decide
+// which tiles to draw. Build with optimizations turned on, e.g.
+// `cmake -DCMAKE_BUILD_TYPE=Release`, and run `view_bench` from the build
+// directory. It needs no window, so it leaves out the cost of rendering.
+
+#include "tile_tracker.hxx"
+#include "viewport.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using Clock = std::chrono::steady_clock;
+
+// The number of frames to time in each phase.
+static int const frames = 1000;
+
+// Returns the number of microseconds since start.
+static double
+us_since(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start)
+            .count();
+}
+
+// Returns a random covered cell without a mine, or {-1, -1} if none is
+// found after a few tries.
+static Model::Position
+random_safe_cell(Model const& model, Rng& rng)
+{
+    Model::Dimensions dims = model.get_board_dimensions();
+    for (int tries = 0; tries < 1000; tries++)
+    {
+        Model::Position pos{rng(0, dims.width - 1), rng(0, dims.height - 1)};
+        Cell const& cell = model.get_board()[pos];
+        if (cell.is_covered() && ! cell.is_mine() && ! cell.is_flagged())
+        {
+            return pos;
+        }
+    }
+    return {-1, -1};
+}
+
+// Times a frame's worth of deciding which tiles to draw on an
+// expert-density board: looking at every cell, as View::draw used to, and
+// following the change journal with a Tile_tracker while nothing happens,
+// while a cell is flagged each frame, and while a cell is revealed each
+// frame.
+static void
+bench_frames(Model::Dimensions dims)
+{
+    Rng rng(211);
+    Model model(Game_config::with_density(dims, 99.0 / 480), rng);
+
+    // Every cell, every frame.
+    long checksum = 0;
+    Clock::time_point start = Clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        for (auto p : model.get_board())
+        {
+            checksum += int(Tile_tracker::tile_of(p.second));
+        }
+    }
+    double scan_us = us_since(start) / frames;
+
+    // The first update hands out every cell; after that, only changes.
+    Tile_tracker tracker;
+    std::vector<Tile_tracker::Update> updates;
+    tracker.update(model, updates);
+
+    start = Clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        tracker.update(model, updates);
+        checksum += int(updates.size());
+    }
+    double idle_us = us_since(start) / frames;
+
+    start = Clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        model.flag({frame % dims.width, frame / dims.width % dims.height});
+        tracker.update(model, updates);
+        checksum += int(updates.size());
+    }
+    double flag_us = us_since(start) / frames;
+
+    // Reveals are picked beforehand, so picking isn't timed.
+    long tiles = 0;
+    int reveals = 0;
+    double reveal_us = 0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        Model::Position pos = random_safe_cell(model, rng);
+        if (pos.x < 0)
+        {
+            break;
+        }
+        start = Clock::now();
+        model.reveal(pos);
+        tracker.update(model, updates);
+        reveal_us += us_since(start);
+        tiles += long(updates.size());
+        reveals++;
+    }
+    reveal_us /= std::max(reveals, 1);
+
+    std::cout << std::setw(12) << dims.width << "x" << std::left
+              << std::setw(8) << dims.height << std::right
+              << std::setw(14) << scan_us
+              << std::setw(12) << idle_us
+              << std::setw(12) << flag_us
+              << std::setw(12) << reveal_us
+              << std::setw(14) << double(tiles) / std::max(reveals, 1)
+              << (checksum < 0 ? "!" : "") << "\n";
+}
+
+// Does what View::draw does each frame to decide which tiles to draw and
+// where, with the window showing `viewport`, which `moved` since the last
+// frame or not. Returns the number of tiles drawn.
+static long
+viewport_frame(Model const& model, Viewport const& viewport, bool moved,
+               Tile_tracker& tracker,
+               std::vector<Tile_tracker::Update>& updates, long& checksum)
+{
+    if (moved)
+    {
+        tracker.forget();
+    }
+    tracker.update(model, viewport.visible_cells(), updates);
+    for (Tile_tracker::Update const& update : updates)
+    {
+        Viewport::Position pixel = viewport.board_to_screen(update.pos);
+        checksum += pixel.x + pixel.y + int(update.tile);
+    }
+    return long(updates.size());
+}
+
+// Times a frame's worth of deciding which tiles to draw on an
+// expert-density board bigger than the window, which shows a 1280 x 768
+// pixel viewport of it: while nothing happens, while it scrolls a little
+// each frame at full size and zoomed out as far as it goes, and while a
+// cell on the screen is revealed each frame.
+static void
+bench_viewport(Model::Dimensions dims)
+{
+    Rng rng(211);
+    Clock::time_point start = Clock::now();
+    Model model(Game_config::with_density(dims, 99.0 / 480), rng);
+    double setup_ms = us_since(start) / 1000;
+
+    Viewport viewport(dims, {1280, 768}, 32);
+    viewport.scroll_by({dims.width * 16, dims.height * 16});
+    Tile_tracker tracker;
+    std::vector<Tile_tracker::Update> updates;
+    long checksum = 0;
+    viewport_frame(model, viewport, true, tracker, updates, checksum);
+
+    start = Clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        viewport_frame(model, viewport, false, tracker, updates, checksum);
+    }
+    double idle_us = us_since(start) / frames;
+
+    double scroll_us[2];
+    long scroll_tiles[2];
+    for (int zoomed_out = 0; zoomed_out < 2; zoomed_out++)
+    {
+        if (zoomed_out)
+        {
+            viewport.zoom(-100, {640, 384});
+        }
+        scroll_tiles[zoomed_out] = 0;
+        start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            viewport.scroll_by({frame % 2 ? 5 : -5, 3});
+            scroll_tiles[zoomed_out] +=
+                    viewport_frame(model, viewport, true, tracker, updates,
+                                   checksum);
+        }
+        scroll_us[zoomed_out] = us_since(start) / frames;
+        scroll_tiles[zoomed_out] /= frames;
+    }
+
+    // Reveal cells on the screen, picked beforehand so picking isn't
+    // timed.
+    Viewport::Rectangle cells = viewport.visible_cells();
+    double reveal_us = 0;
+    int reveals = 0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        Model::Position pos{rng(cells.x, cells.x + cells.width - 1),
+                            rng(cells.y, cells.y + cells.height - 1)};
+        Cell const& cell = model.get_board()[pos];
+        if (! cell.is_covered() || cell.is_mine() || cell.is_flagged())
+        {
+            continue;
+        }
+        start = Clock::now();
+        model.reveal(pos);
+        viewport_frame(model, viewport, false, tracker, updates, checksum);
+        reveal_us += us_since(start);
+        reveals++;
+    }
+    reveal_us /= std::max(reveals, 1);
+
+    std::cout << std::setw(12) << dims.width << "x" << std::left
+              << std::setw(8) << dims.height << std::right
+              << std::setw(12) << setup_ms
+              << std::setw(10) << idle_us
+              << std::setw(12) << scroll_us[0]
+              << std::setw(8) << scroll_tiles[0]
+              << std::setw(12) << scroll_us[1]
+              << std::setw(8) << scroll_tiles[1]
+              << std::setw(12) << reveal_us
+              << (checksum == 42 ? "!" : "") << "\n";
+}
+
+int
+main()
+{
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(21) << "us per frame"
+              << std::setw(14) << "every cell"
+              << std::setw(12) << "idle"
+              << std::setw(12) << "flag"
+              << std::setw(12) << "reveal"
+              << std::setw(14) << "tiles/reveal" << "\n";
+
+    for (Model::Dimensions dims : {Model::Dimensions{30, 16},
+                                   Model::Dimensions{100, 100},
+                                   Model::Dimensions{500, 500}})
+    {
+        bench_frames(dims);
+    }
+
+    std::cout << "\n" << std::setw(21) << "us per frame"
+              << std::setw(12) << "setup ms"
+              << std::setw(10) << "idle"
+              << std::setw(12) << "scroll"
+              << std::setw(8) << "tiles"
+              << std::setw(12) << "zoomed out"
+              << std::setw(8) << "tiles"
+              << std::setw(12) << "reveal" << "\n";
+
+    for (Model::Dimensions dims : {Model::Dimensions{500, 500},
+                                   Model::Dimensions{10000, 10000}})
+    {
+        bench_viewport(dims);
+    }
+
+    return 0;
+}
@@ -0,0 +1,340 @@
+#include "bitboard.hxx"
+
+#include <algorithm>
+#include <cstring>
+
+// The vector types below use the GCC/Clang vector extension. AVX2 is only
+// used when the compiler can build a single function for it and check for
+// it at run time.
+#if defined(__GNUC__)
+#  define MINES_INLINE inline __attribute__((always_inline))
+#  if defined(__SSE2__)
+#    define MINES_HAVE_SSE2 1
+#  endif
+#  if defined(__x86_64__) || defined(__i386__)
+#    define MINES_HAVE_AVX2 1
+     // The helpers that take and return AVX2 vectors are always inlined
+     // into add_row_avx2, so their calling convention never matters.
+#    pragma GCC diagnostic ignored "-Wpsabi"
+#  endif
+#else
+#  define MINES_INLINE inline
+#endif
+
+#ifndef MINES_HAVE_SSE2
+#  define MINES_HAVE_SSE2 0
+#endif
+#ifndef MINES_HAVE_AVX2
+#  define MINES_HAVE_AVX2 0
+#endif
+
+namespace {
+
+// Words of 64 cells each, and vectors of 2 or 4 such words. The vectors use
+// the compiler's vector extension, so the bitwise operators below turn into
+// SSE2 or AVX2 instructions.
+using Word = uint64_t;
+#if MINES_HAVE_AVX2 || MINES_HAVE_SSE2
+using Word2 = uint64_t __attribute__((vector_size(16), aligned(8)));
+using Word4 = uint64_t __attribute__((vector_size(32), aligned(8)));
+#endif
+
+// The output of adding up the eight neighbours of V-many cells at once: the
+// count of each cell is the sum of `ones`, 2 * `twos`, 4 * `fours` and
+// 8 * `eights`, taking the same bit from each.
+template <typename V>
+struct Bit_counts
+{
+    V ones, twos, fours, eights;
+};
+
+// Adds up eight words of one-bit values, bit by bit, with full adders. This
+// is always inlined, so its vector instructions match the caller's.
+template <typename V>
+MINES_INLINE Bit_counts<V>
+add_eight(V n0, V n1, V n2, V n3, V n4, V n5, V n6, V n7)
+{
+    // Three adders take the eight inputs down to three ones and three twos.
+    V a_sum = n0 ^ n1 ^ n2;
+    V a_carry = (n0 & n1) | (n2 & (n0 ^ n1));
+    V b_sum = n3 ^ n4 ^ n5;
+    V b_carry = (n3 & n4) | (n5 & (n3 ^ n4));
+    V c_sum = n6 ^ n7;
+    V c_carry = n6 & n7;
+
+    // The three ones make one more two.
+    V ones = a_sum ^ b_sum ^ c_sum;
+    V d_carry = (a_sum & b_sum) | (c_sum & (a_sum ^ b_sum));
+
+    // The four twos make the twos bit, and up to two fours.
+    V e_sum = a_carry ^ b_carry ^ c_carry;
+    V e_carry = (a_carry & b_carry) | (c_carry & (a_carry ^ b_carry));
+    V twos = e_sum ^ d_carry;
+    V f_carry = e_sum & d_carry;
+
+    return {ones, twos, e_carry ^ f_carry, e_carry & f_carry};
+}
+
+// Loads V-many words from memory that need not be aligned.
+template <typename V>
+MINES_INLINE V
+load(Word const* words)
+{
+    V result;
+    std::memcpy(&result, words, sizeof result);
+    return result;
+}
+
+template <typename V>
+MINES_INLINE void
+store(Word* words, V value)
+{
+    std::memcpy(words, &value, sizeof value);
+}
+
+// Returns V-many words of row r starting at w, shifted so that each bit
+// holds the mine to the left of its cell.
+template <typename V>
+MINES_INLINE V
+west(Word const* r, size_t w)
+{
+    return (load<V>(r + w) << 1) | (load<V>(r + w - 1) >> 63);
+}
+
+// Returns V-many words of row r starting at w, shifted so that each bit
+// holds the mine to the right of its cell.
+template <typename V>
+MINES_INLINE V
+east(Word const* r, size_t w)
+{
+    return (load<V>(r + w) >> 1) | (load<V>(r + w + 1) << 63);
+}
+
+// Adds up the neighbours of V-many words of a row at index w, given the rows
+// above, at and below it. Each row has a padding word on either side, so the
+// words at w - 1 and w + V are always there.
+template <typename V>
+MINES_INLINE void
+add_neighbours(Word const* above, Word const* at, Word const* below,
+               size_t w, Word* planes[4])
+{
+    Bit_counts<V> counts = add_eight<V>(
+            west<V>(above, w), load<V>(above + w), east<V>(above, w),
+            west<V>(at, w), east<V>(at, w),
+            west<V>(below, w), load<V>(below + w), east<V>(below, w));
+
+    store(planes[0] + w, counts.ones);
+    store(planes[1] + w, counts.twos);
+    store(planes[2] + w, counts.fours);
+    store(planes[3] + w, counts.eights);
+}
+
+void
+add_row_words(Word const* above, Word const* at, Word const* below,
+              size_t first, size_t words, Word* planes[4])
+{
+    for (size_t w = first; w < words; w++)
+    {
+        add_neighbours<Word>(above, at, below, w, planes);
+    }
+}
+
+#if MINES_HAVE_SSE2
+void
+add_row_sse2(Word const* above, Word const* at, Word const* below,
+             size_t words, Word* planes[4])
+{
+    size_t w = 0;
+    for (; w + 2 <= words; w += 2)
+    {
+        add_neighbours<Word2>(above, at, below, w, planes);
+    }
+    add_row_words(above, at, below, w, words, planes);
+}
+#endif
+
+#if MINES_HAVE_AVX2
+__attribute__((target("avx2"))) void
+add_row_avx2(Word const* above, Word const* at, Word const* below,
+             size_t words, Word* planes[4])
+{
+    size_t w = 0;
+    for (; w + 4 <= words; w += 4)
+    {
+        add_neighbours<Word4>(above, at, below, w, planes);
+    }
+    add_row_words(above, at, below, w, words, planes);
+}
+#endif
+
+// spread_bits[b] has bit j of b in the lowest bit of byte j, so it turns
+// eight one-bit values into eight bytes.
+struct Spread_table
+{
+    uint64_t entries[256];
+
+    Spread_table()
+    {
+        for (int b = 0; b < 256; b++)
+        {
+            entries[b] = 0;
+            for (int j = 0; j < 8; j++)
+            {
+                entries[b] |= uint64_t((b >> j) & 1) << (8 * j);
+            }
+        }
+    }
+
+    uint64_t operator[](uint64_t b) const
+    {
+        return entries[b];
+    }
+};
+
+Spread_table const spread_bits;
+
+}  // end anonymous namespace
+
+
+Mine_bitboard::Mine_bitboard(Dimensions dims)
+        : dims_(dims),
+          words_per_row_((dims.width + 63) / 64),
+          mines_((words_per_row_ + 2) * (dims.height + 2), 0)
+{ }
+
+
+void
+Mine_bitboard::clear()
+{
+    std::fill(mines_.begin(), mines_.end(), 0);
+}
+
+
+uint64_t const*
+Mine_bitboard::row(int y) const
+{
+    // Skip the empty row at the top, and the padding word on the left.
+    return mines_.data() + (y + 1) * (words_per_row_ + 2) + 1;
+}
+
+
+uint64_t*
+Mine_bitboard::row(int y)
+{
+    return mines_.data() + (y + 1) * (words_per_row_ + 2) + 1;
+}
+
+
+void
+Mine_bitboard::set(Position pos, bool m)
+{
+    uint64_t bit = uint64_t(1) << (pos.x % 64);
+    uint64_t& word = row(pos.y)[pos.x / 64];
+    word = m ? (word | bit) : (word & ~bit);
+}
+
+
+void
+Mine_bitboard::set_word(int y, size_t w, uint64_t bits)
+{
+    row(y)[w] = bits;
+}
+
+
+bool
+Mine_bitboard::get(Position pos) const
+{
+    return (row(pos.y)[pos.x / 64] >> (pos.x % 64)) & 1;
+}
+
+
+void
+Mine_bitboard::count_adjacent_row(int y, uint8_t* counts, Simd simd) const
+{
+    // The four bit planes of the counts for this row. Rows are rarely
+    // wider than a few thousand cells, so these live on the stack in
+    // chunks.
+    static size_t const chunk_words = 64;
+    Word plane_words[4][chunk_words];
+    Word* planes[4] = {plane_words[0], plane_words[1],
+                       plane_words[2], plane_words[3]};
+
+    for (size_t first = 0; first < words_per_row_; first += chunk_words)
+    {
+        size_t words = std::min(chunk_words, words_per_row_ - first);
+        Word const* above = row(y - 1) + first;
+        Word const* at = row(y) + first;
+        Word const* below = row(y + 1) + first;
+
+        switch (simd)
+        {
+#if MINES_HAVE_AVX2
+        case Simd::avx2:
+            add_row_avx2(above, at, below, words, planes);
+            break;
+#endif
+#if MINES_HAVE_SSE2
+        case Simd::sse2:
+            add_row_sse2(above, at, below, words, planes);
+            break;
+#endif
+        default:
+            add_row_words(above, at, below, 0, words, planes);
+            break;
+        }
+
+        // Put the bits of each cell's count back together, eight cells at a
+        // time.
+        for (size_t w = 0; w < words; w++)
+        {
+            int x0 = int(first + w) * 64;
+            int cells = std::min(64, dims_.width - x0);
+            for (int i = 0; i < cells; i += 8)
+            {
+                uint64_t eight_counts =
+                        spread_bits[(plane_words[0][w] >> i) & 0xFF] |
+                        spread_bits[(plane_words[1][w] >> i) & 0xFF] << 1 |
+                        spread_bits[(plane_words[2][w] >> i) & 0xFF] << 2 |
+                        spread_bits[(plane_words[3][w] >> i) & 0xFF] << 3;
+                uint8_t* out = counts + x0 + i;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+                // The lowest byte is already first in memory, so all eight
+                // counts can be stored at once.
+                if (i + 8 <= cells)
+                {
+                    std::memcpy(out, &eight_counts, 8);
+                    continue;
+                }
+#endif
+                for (int j = 0; j < 8 && i + j < cells; j++)
+                {
+                    out[j] = uint8_t(eight_counts >> (8 * j));
+                }
+            }
+        }
+    }
+}
+
+
+size_t
+Mine_bitboard::memory_footprint() const
+{
+    return sizeof(Mine_bitboard) + mines_.capacity() * sizeof(uint64_t);
+}
+
+
+Mine_bitboard::Simd
+Mine_bitboard::best_simd()
+{
+#if MINES_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return Simd::avx2;
+    }
+#endif
+#if MINES_HAVE_SSE2
+    return Simd::sse2;
+#else
+    return Simd::none;
+#endif
+}
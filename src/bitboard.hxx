@@ -0,0 +1,73 @@
+#pragma once
+
+#include <ge211.hxx>
+#include <cstdint>
+#include <vector>
+
+// A grid of mines stored as one bitset per row, 64 cells to a word. It
+// computes the number of mines adjacent to every cell of a row at once, by
+// adding up the eight shifted neighbour rows with bitwise full adders.
+class Mine_bitboard
+{
+public:
+    // Mine_bitboard dimensions will use `int` coordinates, as board
+    // dimensions do.
+    using Dimensions = ge211::Dims<int>;
+
+    // Mine_bitboard positions will use `int` coordinates, as board
+    // positions do.
+    using Position = ge211::Posn<int>;
+
+    // Which instructions count_adjacent_row uses to add the rows up.
+    enum class Simd
+    {
+        // Plain 64-bit words. Works everywhere.
+        none,
+        // 128-bit SSE2 registers. Every x86-64 processor has these.
+        sse2,
+        // 256-bit AVX2 registers, on processors that have them.
+        avx2,
+    };
+
+    // Constructs an empty bitboard with the given dimensions.
+    explicit Mine_bitboard(Dimensions dims);
+
+    // Removes every mine.
+    void clear();
+
+    // Adds or removes a mine at a position.
+    void set(Position, bool m);
+
+    // Returns whether there's a mine at a position.
+    bool get(Position) const;
+
+    // Replaces the mines in 64 cells of row y at once, starting from
+    // x = 64 * w. Bit i of `bits` is the mine at x = 64 * w + i; the bits
+    // past the right edge of the board must be 0.
+    void set_word(int y, size_t w, uint64_t bits);
+
+    // Writes the number of mines adjacent to each cell of row y into
+    // counts[0] through counts[width - 1]. Uses the given instructions,
+    // which must be supported by this computer.
+    void count_adjacent_row(int y, uint8_t* counts, Simd) const;
+
+    // Returns the number of bytes of memory the bitboard uses.
+    size_t memory_footprint() const;
+
+    // Returns the fastest instructions this computer supports.
+    static Simd best_simd();
+
+private:
+    Dimensions dims_;
+
+    // The number of words in each row.
+    size_t words_per_row_;
+
+    // The mines, row by row, with an empty row above and below the board
+    // so every real row has a row on either side.
+    std::vector<uint64_t> mines_;
+
+    // Returns the first word of row y, which may be -1 or dims_.height.
+    uint64_t const* row(int y) const;
+    uint64_t* row(int y);
+};
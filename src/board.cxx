@@ -1,50 +1,355 @@
 #include "board.hxx"
+#include "mine_placement.hxx"
+#include "no_guess.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 
 using namespace ge211;
 
-// The number of mines randomly placed on the board.
-static const int mine_num = 49;
+// Returns a cell that sits in the padded border around the board. It has no
+// mine and is already uncovered, so it is never revealed or counted.
+static Cell
+border_cell()
+{
+    Cell c(false);
+    c.uncover();
+    return c;
+}
+
+// Returns the generator for boards made without one: one per thread, seeded
+// unpredictably the first time it's used.
+static Rng&
+unseeded_rng()
+{
+    thread_local Rng rng = Rng::from_entropy();
+    return rng;
+}
+
+// Returns the working memory for choosing where mines go, which is kept so
+// that making board after board on a thread doesn't allocate.
+static Mine_placer&
+thread_mine_placer()
+{
+    thread_local Mine_placer placer;
+    return placer;
+}
+
+// Returns the generator that no-guess boards made on this thread use. It
+// checks candidates on one thread, since a board is usually found after a
+// few, and games are often played on many threads already.
+static No_guess_generator&
+thread_no_guess_generator()
+{
+    thread_local No_guess_generator generator;
+    return generator;
+}
+
+// The most cells a no-guess board checks, over all its candidate layouts,
+// before it gives up. A candidate takes about a third of a microsecond per
+// cell to check, so this keeps a first click from holding up the game for
+// more than a moment, while still trying a few thousand expert boards.
+static int64_t const no_guess_cell_budget = int64_t(1) << 20;
+
+// The most changes the journal keeps before it begins a new epoch instead.
+// Reading more than this is about as costly as looking at the cells a
+// screen can show, so there's little point keeping them.
+static size_t const max_journal_length = size_t(1) << 16;
+
+// Returns a journal epoch that no Board has had yet, so that a cursor can
+// never mistake one Board's journal for another's.
+static uint64_t
+new_journal_epoch()
+{
+    static std::atomic<uint64_t> next_epoch(1);
+    return next_epoch++;
+}
 
 Board::Board()
-        : Board(Board::Dimensions{30, 16})
+        : Board(Game_config())
 { }
 
 Board::Board(Dimensions dims)
-        : board_(),
-          dims_(dims)
+        : Board(Game_config(dims, Game_config().mines))
+{ }
+
+Board::Board(Game_config const& config)
+        : Board(config, unseeded_rng())
+{ }
+
+Board::Board(Game_config const& config, Rng& rng)
+        : Board(config, Unplaced())
+{
+    reset(rng);
+}
+
+
+Board::Board(Game_config const& config, Rng& rng, Position first_click)
+        : Board(config, Unplaced())
+{
+    reset(rng, first_click);
+}
+
+
+Board::Board(Game_config const& config, Unplaced)
+        : cells_(size_t(config.dims.width + 2) *
+                         size_t(config.dims.height + 2),
+                 border_cell()),
+          dims_(config.dims),
+          mine_count_(int(std::max(int64_t(0),
+                                   std::min(int64_t(config.mines),
+                                            config.cells())))),
+          no_guess_(config.no_guess),
+          stride_(dims_.width + 2),
+          neighbour_offsets_{-stride_ - 1, -stride_, -stride_ + 1,
+                             -1, 1,
+                             stride_ - 1, stride_, stride_ + 1},
+          adjacency_engine_(Adjacency_engine::bitboard),
+          bulk_edit_(false),
+          mine_bits_(dims_),
+          covered_safe_cells_(int(config.cells())),
+          flag_count_(0),
+          journal_epoch_(new_journal_epoch())
+{
+    // A flood fill rarely needs more seeds than there are rows and columns.
+    reveal_seeds_.reserve(dims_.width + dims_.height);
+}
+
+
+void
+Board::reset(Rng& rng)
+{
+    place_random_mines(rng);
+}
+
+
+bool
+Board::reset(Rng& rng, Position first_click)
+{
+    if (no_guess_)
+    {
+        int64_t cells = int64_t(dims_.width) * dims_.height;
+        No_guess_generator& generator = thread_no_guess_generator();
+        generator.set_max_candidates(
+                std::max(no_guess_cell_budget / cells, int64_t(1)));
+
+        // Candidate layouts are numbered streams of one seed, so the one
+        // found can be made again here.
+        uint64_t seed = rng();
+        int64_t found = generator.find(Game_config(dims_, mine_count_),
+                                       first_click, seed);
+        Rng layout = Rng::stream(seed, uint64_t(std::max(found, int64_t(0))));
+        place_random_mines(layout, first_click);
+        return found >= 0;
+    }
+    else
+    {
+        place_random_mines(rng, first_click);
+        return true;
+    }
+}
+
+
+void
+Board::move_mines_away(Position first_click, bool opening, Rng& rng)
 {
-    // A vector that will hold all Positions on the board.
-    std::vector<Board::Position> all_positions;
-    for (int w = 0; w < dims_.width; w++)
+    int radius = opening ? 1 : 0;
+    int kept_clear = 0;
+    for (int y = first_click.y - radius; y <= first_click.y + radius; y++)
     {
-        for (int h = 0; h < dims_.height; h++)
+        for (int x = first_click.x - radius; x <= first_click.x + radius; x++)
         {
-            // Generate a default cell for every Position on the Board.
-            board_.emplace(Position{w,h}, Cell(false));
-            // Add a Position to all_positions.
-            all_positions.push_back(Position{w, h});
+            kept_clear += good_position({x, y});
         }
     }
-    // Initialize an unbounded random number generator.
-    ge211::Random_source<int> r(ge211::unbounded);
-    for (int i = 0; i < mine_num; i++)
+    if (mine_count_ > dims_.width * dims_.height - kept_clear)
     {
-        // Generate a random number.
-        int rand_num = r(0, 480 - 1 - i);
-        // Put a mine in a random position in board_.
-        board_[all_positions.at(rand_num)].set_mine(true);
-        // Remove that random position from the all_positions vector.
-        all_positions.erase(all_positions.begin() + rand_num);
+        radius = 0;
     }
-    // Ensure the "adjacent_mines" trait of every Cell is correct.
-    guarantee_adjacent_mines();
+
+    for (int y = first_click.y - radius; y <= first_click.y + radius; y++)
+    {
+        for (int x = first_click.x - radius; x <= first_click.x + radius; x++)
+        {
+            if (! good_position({x, y}) || ! cells_[index({x, y})].is_mine())
+            {
+                continue;
+            }
+            size_t to;
+            if (! find_cell_without_mine(first_click, radius, rng, to))
+            {
+                return;
+            }
+            set_mine({x, y}, false);
+            set_mine({int(to % stride_) - 1, int(to / stride_) - 1}, true);
+        }
+    }
+}
+
+
+bool
+Board::find_cell_without_mine(Position centre, int radius, Rng& rng,
+                              size_t& found) const
+{
+    int cells = dims_.width * dims_.height;
+    auto fits = [&](int n) {
+        int x = n % dims_.width;
+        int y = n / dims_.width;
+        return (std::abs(x - centre.x) > radius ||
+                std::abs(y - centre.y) > radius) &&
+               ! cells_[index({x, y})].is_mine();
+    };
+
+    // Usually most cells have no mine, so a few random tries find one.
+    for (int tries = 0; tries < 32 && cells > 0; tries++)
+    {
+        int n = rng(0, cells - 1);
+        if (fits(n))
+        {
+            found = index({n % dims_.width, n / dims_.width});
+            return true;
+        }
+    }
+
+    // Otherwise take the first one from a random starting point.
+    int start = cells > 0 ? rng(0, cells - 1) : 0;
+    for (int k = 0; k < cells; k++)
+    {
+        int n = (start + k) % cells;
+        if (fits(n))
+        {
+            found = index({n % dims_.width, n / dims_.width});
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool
+Board::is_no_guess() const
+{
+    return no_guess_;
+}
+
+
+void
+Board::place_random_mines(Rng& rng)
+{
+    // Generate a default cell for every Position on the Board.
+    for (int y = 0; y < dims_.height; y++)
+    {
+        Cell* row = &cells_[index({0, y})];
+        std::fill(row, row + dims_.width, Cell(false));
+    }
+    covered_safe_cells_ = dims_.width * dims_.height;
+    flag_count_ = 0;
+
+    // Put mines in random cells, numbered row by row.
+    begin_bulk_edit();
+    for (int i : thread_mine_placer().choose(dims_.width * dims_.height,
+                                              mine_count_, rng))
+    {
+        set_mine({i % dims_.width, i / dims_.width}, true);
+    }
+    end_bulk_edit();
+}
+
+
+void
+Board::place_random_mines(Rng& rng, Position first_click)
+{
+    // The cells to keep clear, numbered row by row, in order.
+    int keep_clear[9];
+    int kept = 0;
+    for (int y = first_click.y - 1; y <= first_click.y + 1; y++)
+    {
+        for (int x = first_click.x - 1; x <= first_click.x + 1; x++)
+        {
+            if (good_position({x, y}))
+            {
+                keep_clear[kept++] = y * dims_.width + x;
+            }
+        }
+    }
+    int cells = dims_.width * dims_.height;
+    if (mine_count_ > cells - kept)
+    {
+        place_random_mines(rng);
+        return;
+    }
+
+    for (int y = 0; y < dims_.height; y++)
+    {
+        Cell* row = &cells_[index({0, y})];
+        std::fill(row, row + dims_.width, Cell(false));
+    }
+    covered_safe_cells_ = cells;
+    flag_count_ = 0;
+
+    // Choose among the other cells, then skip over the kept cells to find
+    // the number of the cell that was chosen.
+    begin_bulk_edit();
+    for (int i : thread_mine_placer().choose(cells - kept, mine_count_, rng))
+    {
+        for (int k = 0; k < kept && keep_clear[k] <= i; k++)
+        {
+            i++;
+        }
+        set_mine({i % dims_.width, i / dims_.width}, true);
+    }
+    end_bulk_edit();
 }
 
 
-std::unordered_map<Board::Position, Cell>
+Board::Cell_view
 Board::get_board() const
 {
-    return board_;
+    return Cell_view(cells_.data(), dims_, stride_);
+}
+
+
+bool
+Board::changes_since(Journal_cursor& cursor,
+                     std::vector<Position>& changed) const
+{
+    changed.clear();
+    bool same_epoch = cursor.epoch == journal_epoch_;
+    if (same_epoch)
+    {
+        for (size_t k = cursor.next; k < journal_.size(); k++)
+        {
+            size_t i = journal_[k];
+            changed.push_back({int(i % stride_) - 1, int(i / stride_) - 1});
+        }
+    }
+    cursor.epoch = journal_epoch_;
+    cursor.next = journal_.size();
+    return same_epoch;
+}
+
+
+void
+Board::journal_change(size_t i)
+{
+    if (journal_.size() >= std::min(size_t(dims_.width) * dims_.height,
+                                    max_journal_length))
+    {
+        journal_everything();
+    }
+    else
+    {
+        journal_.push_back(i);
+    }
+}
+
+
+void
+Board::journal_everything()
+{
+    journal_.clear();
+    journal_epoch_ = new_journal_epoch();
 }
 
 
@@ -57,32 +362,47 @@ Board::good_position(Board::Position pos) const
 }
 
 
-std::vector<Board::Position>
-Board::surrounding_positions(Board::Position pos)
+size_t
+Board::index(Board::Position pos) const
+{
+    return (pos.y + 1) * stride_ + (pos.x + 1);
+}
+
+
+void
+Board::add_to_adjacent_counts(size_t i, int delta)
 {
-    std::vector<Board::Position> surrounding_positions;
-    for (int x = -1; x <= 1; ++x) {
-        for (int y = -1; y <= 1; ++y) {
-            if ((x || y) && good_position({pos.x + x, pos.y + y})) {
-                surrounding_positions.push_back({pos.x + x, pos.y + y});
+    // Border cells have no counts to keep, so leave out the neighbours
+    // past the edges of the board.
+    int x = int(i % stride_) - 1;
+    int y = int(i / stride_) - 1;
+    int left = x > 0 ? -1 : 0;
+    int right = x < dims_.width - 1 ? 1 : 0;
+    for (int dy = y > 0 ? -1 : 0; dy <= (y < dims_.height - 1 ? 1 : 0); dy++)
+    {
+        Cell* row = &cells_[i + dy * stride_];
+        for (int dx = left; dx <= right; dx++)
+        {
+            if (dx != 0 || dy != 0)
+            {
+                row[dx].set_adjacent_mines(row[dx].get_adjacent_mines() +
+                                           delta);
+                journal_change(i + dy * stride_ + dx);
             }
         }
     }
-    return surrounding_positions;
 }
 
+
 size_t
-Board::mines_adjacent_to_one_pos(Board::Position pos)
+Board::mines_adjacent_to_one_pos(size_t i)
 {
     size_t counter = 0;
-    // Obtain all good positions surrounding pos.
-    std::vector<Board::Position> candidates = surrounding_positions(pos);
-    // Check if there is a mine present in all adjacent positions, and check
-    // that the position is valid.
-    for (Board::Position candidate : candidates)
+    // Check if there is a mine present in all adjacent cells. The border
+    // means every neighbour index is valid, and border cells have no mines.
+    for (int offset : neighbour_offsets_)
     {
-        if (good_position(candidate) &&
-            board_.at({candidate}).is_mine())
+        if (cells_[i + offset].is_mine())
         {
             // Add to the counter if a mine is present in one of the
             // surrounding cells.
@@ -96,43 +416,120 @@ Board::mines_adjacent_to_one_pos(Board::Position pos)
 bool
 Board::reveal(Board::Position pos)
 {
+    Cell& c = cells_[index(pos)];
     // Returns true when the user clicks on an un-flagged cell with a mine.
     // That tells the model the user has lost, pretty much.
-    if ((!board_.at(pos).is_flagged()) && board_[pos].is_mine())
+    if ((!c.is_flagged()) && c.is_mine())
     {
         return true;
     }
     else
     {
         // Attempts to reveal the cell.
-        reveal_helper(pos);
+        reveal_helper(index(pos));
         return false;
     }
 }
 
 
+bool
+Board::is_opening(size_t i) const
+{
+    Cell const& c = cells_[i];
+    return c.is_covered() && (! c.is_flagged()) && c.get_adjacent_mines() == 0;
+}
+
+
 void
-Board::reveal_helper(Board::Position pos)
+Board::reveal_helper(size_t i)
 {
+    Cell& c = cells_[i];
     // When the caller is attempting to reveal an empty cell, or a flagged
-    // cell, take no further action.
-    if ((! board_.at(pos).is_covered()) || board_.at(pos).is_flagged()) {
+    // cell, take no further action. This includes the border cells.
+    if ((! c.is_covered()) || c.is_flagged()) {
         return;
     }
     // When the caller is revealing a cell adjacent to a mine, reveal only
     // that cell, and take no further action.
-    else if (board_.at(pos).get_adjacent_mines() != 0)
+    else if (c.get_adjacent_mines() != 0)
     {
-        board_[pos].uncover();
+        uncover_cell(i);
+        return;
+    }
+
+    // Otherwise the cell is part of an opening: reveal it, and everything
+    // around it, and keep going for every neighbour that is also adjacent
+    // to no mines. This works on whole row spans at a time with an explicit
+    // work list, so a huge opening can't overflow the stack.
+    reveal_seeds_.clear();
+    reveal_seeds_.push_back(i);
+    while (! reveal_seeds_.empty())
+    {
+        size_t seed = reveal_seeds_.back();
+        reveal_seeds_.pop_back();
+        // The seed may have been revealed as part of another span already.
+        if (! is_opening(seed))
+        {
+            continue;
+        }
+
+        // Find the run of opening cells in this row that contains the seed.
+        // The border stops both loops, since border cells are uncovered.
+        size_t first = seed;
+        while (is_opening(first - 1))
+        {
+            first--;
+        }
+        size_t last = seed;
+        while (is_opening(last + 1))
+        {
+            last++;
+        }
+
+        // Reveal the run, along with the (numbered) cells at either end of
+        // it, which would have stopped the run unless they're flagged or
+        // already uncovered.
+        for (size_t j = first - 1; j <= last + 1; j++)
+        {
+            if (! cells_[j].is_flagged())
+            {
+                uncover_cell(j);
+            }
+        }
+
+        // Every cell in the rows above and below, including diagonally past
+        // either end, touches the run.
+        reveal_row_next_to_span(first - 1 - stride_, last + 1 - stride_);
+        reveal_row_next_to_span(first - 1 + stride_, last + 1 + stride_);
     }
-    // When the caller is revealing a cell adjacent to no mines, reveal only
-    // that cell, and reveal all positions surrounding that cell.
-    else if (board_.at(pos).get_adjacent_mines() == 0)
+}
+
+
+void
+Board::reveal_row_next_to_span(size_t first, size_t last)
+{
+    bool in_run = false;
+    for (size_t j = first; j <= last; j++)
     {
-        board_[pos].uncover();
-        for (auto p: surrounding_positions(pos))
+        Cell& c = cells_[j];
+        if ((! c.is_covered()) || c.is_flagged())
+        {
+            in_run = false;
+        }
+        else if (c.get_adjacent_mines() != 0)
+        {
+            uncover_cell(j);
+            in_run = false;
+        }
+        else
         {
-            reveal(p);
+            // One seed is enough for each run of openings; the span search
+            // will find the rest of it.
+            if (! in_run)
+            {
+                reveal_seeds_.push_back(j);
+            }
+            in_run = true;
         }
     }
 }
@@ -141,11 +538,14 @@ Board::reveal_helper(Board::Position pos)
 bool
 Board::are_any_cells_revealed()
 {
-    for (auto& c: board_)
+    for (int y = 0; y < dims_.height; y++)
     {
-        if (! c.second.is_covered())
+        for (int x = 0; x < dims_.width; x++)
         {
-            return true;
+            if (! cells_[index({x, y})].is_covered())
+            {
+                return true;
+            }
         }
     }
     return false;
@@ -155,12 +555,15 @@ Board::are_any_cells_revealed()
 void
 Board::flag(Board::Position pos)
 {
+    Cell& c = cells_[index(pos)];
     // Only (un-)flag a Cell if it is covered.
-    if (board_[pos].is_covered())
+    if (c.is_covered())
     {
         // If the Cell at Position pos doesn't have a flag, place a flag on
         // it. If it does have a flag, remove the flag.
-        board_[pos].set_flag(! board_[pos].is_flagged());
+        flag_count_ += c.is_flagged() ? -1 : 1;
+        c.set_flag(! c.is_flagged());
+        journal_change(index(pos));
     }
 }
 
@@ -168,83 +571,213 @@ Board::flag(Board::Position pos)
 void
 Board::uncover_all_besides_flagged()
 {
-    for (auto& c: board_)
+    for (int y = 0; y < dims_.height; y++)
     {
-        if (! c.second.is_flagged())
+        for (int x = 0; x < dims_.width; x++)
         {
-            c.second.uncover();
+            size_t i = index({x, y});
+            if (! cells_[i].is_flagged())
+            {
+                uncover_cell(i);
+            }
         }
-
     }
 }
 
 
 bool
-Board::win()
+Board::win() const
 {
-    // Checks if any covered cells have mines.
-    bool result = true;
-    for (auto c : board_)
-    {
-        if ((! c.second.is_mine()) && c.second.is_covered())
-        {
-            result = false;
-        }
-    }
-    return result;
+    // The user has won once no covered cell is without a mine.
+    return covered_safe_cells_ == 0;
+}
+
+
+int
+Board::get_flag_count() const
+{
+    return flag_count_;
 }
 
 
 int
-Board::get_flag_count()
+Board::covered_safe_cells() const
+{
+    return covered_safe_cells_;
+}
+
+
+void
+Board::uncover_cell(size_t i)
 {
-    int count = 0;
-    for (auto p: board_)
+    Cell& c = cells_[i];
+    if (c.is_covered())
     {
-        if (p.second.is_flagged())
+        if (! c.is_mine())
         {
-            count++;
+            covered_safe_cells_--;
         }
+        if (c.is_flagged())
+        {
+            flag_count_--;
+        }
+        c.uncover();
+        journal_change(i);
     }
-
-    return count;
 }
 
 Board::Dimensions
-Board::dimensions()
+Board::dimensions() const
 {
     return dims_;
 }
 
+int
+Board::mine_count() const
+{
+    return mine_count_;
+}
+
 void
 Board::clear_mines_on_board()
 {
-    for (auto& p : board_)
+    for (int y = 0; y < dims_.height; y++)
     {
-        p.second.set_mine(false);
-        p.second.set_adjacent_mines(0);
+        for (int x = 0; x < dims_.width; x++)
+        {
+            Cell& c = cells_[index({x, y})];
+            // A covered mine becomes a covered cell without a mine.
+            if (c.is_covered() && c.is_mine())
+            {
+                covered_safe_cells_++;
+            }
+            c.set_mine(false);
+            c.set_adjacent_mines(0);
+        }
     }
+    journal_everything();
 }
 
 void
 Board::set_mine(Board::Position pos, bool m)
 {
-    board_[pos].set_mine(m);
+    size_t i = index(pos);
+    Cell& c = cells_[i];
+    if (c.is_mine() == m)
+    {
+        return;
+    }
+    // Keep count of the covered cells without mines.
+    if (c.is_covered())
+    {
+        covered_safe_cells_ += m ? -1 : 1;
+    }
+    c.set_mine(m);
+    // Keep the neighbours' counts right, unless a bulk edit is going to
+    // recount them all at the end.
+    if (! bulk_edit_)
+    {
+        journal_change(i);
+        add_to_adjacent_counts(i, m ? 1 : -1);
+    }
+}
+
+void
+Board::begin_bulk_edit()
+{
+    bulk_edit_ = true;
+}
+
+void
+Board::end_bulk_edit()
+{
+    bulk_edit_ = false;
+    guarantee_adjacent_mines();
 }
 
 void
 Board::guarantee_adjacent_mines()
 {
+    journal_everything();
     // Ensure the "adjacent_mines" trait of every Cell is correct.
-    for (auto& i : board_)
+    if (adjacency_engine_ == Adjacency_engine::bitboard)
+    {
+        guarantee_adjacent_mines_bitboard();
+    }
+    else
+    {
+        guarantee_adjacent_mines_scalar();
+    }
+}
+
+void
+Board::guarantee_adjacent_mines_scalar()
+{
+    for (int y = 0; y < dims_.height; y++)
+    {
+        for (int x = 0; x < dims_.width; x++)
+        {
+            size_t i = index({x, y});
+            // Obtain the number of mines adjacent to the given position, and
+            // set the number of adjacent mines in this Cell. Cells with mines
+            // get a count too, though nothing shows it.
+            cells_[i].set_adjacent_mines(mines_adjacent_to_one_pos(i));
+        }
+    }
+}
+
+void
+Board::guarantee_adjacent_mines_bitboard()
+{
+    // Copy the mines into the bitboard, 64 cells at a time.
+    for (int y = 0; y < dims_.height; y++)
+    {
+        Cell const* row = &cells_[index({0, y})];
+        for (int x0 = 0; x0 < dims_.width; x0 += 64)
+        {
+            uint64_t bits = 0;
+            int cells = std::min(64, dims_.width - x0);
+            for (int i = 0; i < cells; i++)
+            {
+                bits |= uint64_t(row[x0 + i].is_mine()) << i;
+            }
+            mine_bits_.set_word(y, x0 / 64, bits);
+        }
+    }
+
+    // Count a row at a time, and copy the counts back into the cells.
+    Mine_bitboard::Simd simd = Mine_bitboard::best_simd();
+    row_counts_.resize(dims_.width);
+    for (int y = 0; y < dims_.height; y++)
     {
-        // Check that there isn't a mine in the Cell at the position.
-        if (! i.second.is_mine())
+        mine_bits_.count_adjacent_row(y, row_counts_.data(), simd);
+        Cell* row = &cells_[index({0, y})];
+        for (int x = 0; x < dims_.width; x++)
         {
-            // Obtain the number of mines adjacent to the given position.
-            size_t num = mines_adjacent_to_one_pos(i.first);
-            // Set the number of adjacent mines in this Cell.
-            i.second.set_adjacent_mines(num);
+            row[x].set_adjacent_mines(row_counts_[x]);
         }
     }
 }
+
+void
+Board::set_adjacency_engine(Adjacency_engine engine)
+{
+    adjacency_engine_ = engine;
+}
+
+Board::Adjacency_engine
+Board::adjacency_engine() const
+{
+    return adjacency_engine_;
+}
+
+size_t
+Board::memory_footprint() const
+{
+    return sizeof(Board) +
+           cells_.capacity() * sizeof(Cell) +
+           reveal_seeds_.capacity() * sizeof(size_t) +
+           mine_bits_.memory_footprint() +
+           row_counts_.capacity() +
+           journal_.capacity() * sizeof(size_t);
+}
@@ -1,9 +1,16 @@
 #pragma once
 
 #include <ge211.hxx>
+#include <array>
+#include <cstdint>
 #include <iostream>
-#include <unordered_map>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "bitboard.hxx"
 #include "cell.hxx"
+#include "game_config.hxx"
+#include "rng.hxx"
 
 class Board
 {
@@ -15,17 +22,185 @@ public:
     // Board positions will use `int` coordinates.
     using Position = ge211::Posn<int>;
 
-    // Default constructor
+    // The ways guarantee_adjacent_mines can count the mines adjacent to
+    // each cell. They always give the same counts.
+    enum class Adjacency_engine
+    {
+        // Looks at the eight neighbours of one cell at a time.
+        scalar,
+        // Copies the mines into a Mine_bitboard and adds up whole rows of
+        // neighbours at once, using SIMD instructions when it can.
+        bitboard,
+    };
+
+    // A read-only, non-owning view of the cells on a Board. Iterating over
+    // it visits every cell in row-major order as a pair of its Position and
+    // a reference to the Cell, without copying or allocating anything. The
+    // view sees later changes to the Board, and it is only valid as long as
+    // the Board it came from.
+    class Cell_view
+    {
+    public:
+        // What iterating over the view produces.
+        using value_type = std::pair<Position, Cell const&>;
+
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Cell_view::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = value_type;
+
+            iterator(Cell_view const* view, Position pos)
+                    : view_(view), pos_(pos)
+            { }
+
+            value_type operator*() const
+            {
+                return {pos_, (*view_)[pos_]};
+            }
+
+            iterator& operator++()
+            {
+                if (++pos_.x == view_->dims_.width)
+                {
+                    pos_.x = 0;
+                    ++pos_.y;
+                }
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator result(*this);
+                ++*this;
+                return result;
+            }
+
+            bool operator==(iterator const& other) const
+            {
+                return pos_ == other.pos_;
+            }
+
+            bool operator!=(iterator const& other) const
+            {
+                return !(*this == other);
+            }
+
+        private:
+            Cell_view const* view_;
+            Position pos_;
+        };
+
+        Cell_view(Cell const* cells, Dimensions dims, int stride)
+                : cells_(cells), dims_(dims), stride_(stride)
+        { }
+
+        // Returns the Cell at a (good) position.
+        Cell const& operator[](Position pos) const
+        {
+            return cells_[(pos.y + 1) * stride_ + (pos.x + 1)];
+        }
+
+        // The dimensions of the Board being viewed.
+        Dimensions dimensions() const
+        {
+            return dims_;
+        }
+
+        iterator begin() const
+        {
+            return {this, {0, dims_.width > 0 ? 0 : dims_.height}};
+        }
+
+        iterator end() const
+        {
+            return {this, {0, dims_.height}};
+        }
+
+    private:
+        // The first cell of the (padded) grid of the Board.
+        Cell const* cells_;
+        Dimensions dims_;
+        int stride_;
+    };
+
+    // Where a reader of the change journal has read up to. A new cursor
+    // hasn't read anything yet.
+    struct Journal_cursor
+    {
+        uint64_t epoch = 0;
+        size_t next = 0;
+    };
+
+    // Default constructor. Makes the board of the default Game_config.
     Board();
 
-    // Constructs a board with the given dimensions. Puts 49 mines in random
-    // places on the board.
+    // Constructs a board with the given dimensions, and as many mines as
+    // the default Game_config has.
     Board(Dimensions dims);
 
-    // Returns an unordered_map containing key-value pair representing a
-    // Position and a Cell on the board.
-    std::unordered_map<Position, Cell>
-    get_board() const;
+    // Constructs a board with the size of the given Game_config, which
+    // must be valid, as by Game_config::is_valid_size, and puts its mines
+    // in random places on the board, or a mine in every cell if there are
+    // more mines than cells. The places come from a generator seeded
+    // unpredictably, so every board is different.
+    explicit Board(Game_config const&);
+
+    // Like the constructor above, but takes the places of the mines from
+    // `rng`. Boards made from generators with the same seed are the same.
+    Board(Game_config const&, Rng& rng);
+
+    // Like the constructor above, but places the mines around a first
+    // click at `first_click`, the way reset(rng, first_click) does.
+    Board(Game_config const&, Rng& rng, Position first_click);
+
+    // Starts over with a new board of the same size and number of mines,
+    // taking the places of the mines from `rng`. Every cell is covered and
+    // un-flagged again. This reuses the memory of the old board, so it
+    // doesn't allocate.
+    void reset(Rng& rng);
+
+    // Like reset(rng), but keeps mines out of `first_click` and its
+    // neighbours, so that revealing it opens up an area, unless there are
+    // too many mines to fit elsewhere. If the Game_config asked for no
+    // guessing, the mines are also placed so that the board can be solved
+    // from there without guessing, if a No_guess_generator can find such a
+    // layout among the candidates it has time for on a board this size.
+    // Returns false if it asked for no guessing and none was found, in
+    // which case the board may need a guess.
+    bool reset(Rng& rng, Position first_click);
+
+    // Moves any mine in `first_click` (and, if `opening` is true, in its
+    // neighbours) to a random cell elsewhere without one, chosen by `rng`,
+    // so that revealing it is safe (and opens up an area). If there's no
+    // room for the neighbours' mines, only `first_click` itself is
+    // cleared. Only the counts next to the moved mines change, so this
+    // takes time in proportion to the number of mines moved, not the size
+    // of the board.
+    void move_mines_away(Position first_click, bool opening, Rng& rng);
+
+    // Returns whether the Game_config asked for a board that can be solved
+    // without guessing.
+    bool is_no_guess() const;
+
+    // Returns a view of every Position and Cell on the board. Nothing is
+    // copied, so this is cheap enough to call every frame.
+    Cell_view get_board() const;
+
+    // Catches `cursor` up on the change journal, which records each cell
+    // whose appearance may have changed: by being uncovered, flagged or
+    // un-flagged, or by gaining or losing a mine or an adjacent mine. Sets
+    // `changed` to the cells recorded since the cursor last caught up, in
+    // order and possibly more than once, and returns true. Returns false
+    // instead when any cell at all may have changed: for a new cursor, and
+    // after a reset, a bulk edit, a recount, or more changes than the
+    // journal keeps. This takes time in proportion to the number of changes,
+    // so it's cheap to call every frame.
+    bool changes_since(Journal_cursor& cursor,
+                       std::vector<Position>& changed) const;
 
     // Returns whether the given position is in bounds.
     bool good_position(Position) const;
@@ -44,39 +219,166 @@ public:
     void uncover_all_besides_flagged();
 
     // Returns whether the user has uncovered all non-mine cells on the
-    // board.
-    bool win();
+    // board. This takes constant time.
+    bool win() const;
+
+    // Returns the number of flagged cells on the board. This takes constant
+    // time.
+    int get_flag_count() const;
 
-    // Returns the number of flagged cells on the board.
-    int get_flag_count();
+    // Returns the number of covered cells without mines on the board. The
+    // user wins when it reaches 0.
+    int covered_safe_cells() const;
 
     // Get dimensions passed into the constructor
-    Board::Dimensions dimensions();
+    Board::Dimensions dimensions() const;
 
-    // Clear the board
+    // Returns the number of mines placed on the board when it was made.
+    int mine_count() const;
+
+    // Takes every mine off the board, which leaves every count at 0.
     void clear_mines_on_board();
 
-    // Set a mine
+    // Adds or removes a mine, and updates the counts of adjacent mines of
+    // its neighbours to match, which takes constant time. (During a bulk
+    // edit the counts are left for end_bulk_edit to fix instead.)
     void set_mine(Board::Position, bool m);
 
-    // Guarantee adjacent mines
+    // Starts a bulk edit: until end_bulk_edit is called, set_mine only
+    // changes the mines, not the counts. That's faster when setting a large
+    // fraction of the board's cells at once.
+    void begin_bulk_edit();
+
+    // Ends a bulk edit, and recounts the adjacent mines of every cell at
+    // once, with the adjacency engine.
+    void end_bulk_edit();
+
+    // Recounts the adjacent mines of every cell. set_mine keeps the counts
+    // right by itself, so this is only needed to compare the engines.
     void guarantee_adjacent_mines();
+
+    // Chooses how guarantee_adjacent_mines counts adjacent mines. The
+    // default is Adjacency_engine::bitboard.
+    void set_adjacency_engine(Adjacency_engine);
+
+    // Returns how guarantee_adjacent_mines counts adjacent mines.
+    Adjacency_engine adjacency_engine() const;
+
+    // Returns the number of bytes of memory the Board uses, including its
+    // cells.
+    size_t memory_footprint() const;
 private:
-    // The unordered_map containing all the cells
-    std::unordered_map<ge211::Posn<int>, Cell> board_;
+    // All the cells, stored row-major in one contiguous grid. The grid has
+    // a one-cell border of padding on every side, so the cell at Position
+    // {x, y} lives at index (y + 1) * stride_ + (x + 1). Border cells are
+    // never mines and are already uncovered, so neighbour lookups and the
+    // flood fill in reveal_helper never need a bounds check.
+    std::vector<Cell> cells_;
 
     // The dimensions of the Board.
     Dimensions dims_;
 
-    // A helper function for reveal. It handles the recursive part of
-    // revealing cells on the board.
-    void reveal_helper(Board::Position);
+    // The number of mines placed by the constructor.
+    int mine_count_;
+
+    // Whether the board should be solvable without guessing.
+    bool no_guess_;
+
+    // The number of cells in one padded row, i.e. dims_.width + 2.
+    int stride_;
+
+    // The offsets from a cell's index to the indices of its eight
+    // neighbours.
+    std::array<int, 8> neighbour_offsets_;
+
+    // The work list of the flood fill in reveal_helper. Each entry is the
+    // index of a covered cell with no adjacent mines whose row span still
+    // needs to be revealed. It is kept between calls so that revealing does
+    // not allocate once it has grown to fit the board.
+    std::vector<size_t> reveal_seeds_;
+
+    // How guarantee_adjacent_mines counts adjacent mines.
+    Adjacency_engine adjacency_engine_;
+
+    // Whether a bulk edit is going on, so set_mine should leave the counts
+    // alone.
+    bool bulk_edit_;
+
+    // A copy of the mines for the bitboard adjacency engine, along with
+    // one row of its counts. Both are only filled in when that engine
+    // runs, and are kept so it doesn't have to allocate them again.
+    Mine_bitboard mine_bits_;
+    std::vector<uint8_t> row_counts_;
+
+    // The number of covered cells without a mine, and the number of flagged
+    // cells. Every change to a cell goes through flag, set_mine,
+    // clear_mines_on_board or uncover_cell, which keep these up to date.
+    int covered_safe_cells_;
+    int flag_count_;
+
+    // The change journal: the index of every cell changed since the
+    // journal's epoch began. A new epoch, numbered uniquely across every
+    // Board, begins whenever any cell at all may have changed, which tells
+    // old cursors to start over.
+    std::vector<size_t> journal_;
+    uint64_t journal_epoch_;
+
+    // Records a change to the cell at an index in the journal, or begins a
+    // new epoch if the journal is full.
+    void journal_change(size_t);
+
+    // Begins a new epoch of the journal, since any cell may have changed.
+    void journal_everything();
+
+    // Sets up a board for the given Game_config, with every cell covered
+    // and no mines yet. The public constructors place the mines after.
+    struct Unplaced { };
+    Board(Game_config const&, Unplaced);
+
+    // Covers every cell, takes off the flags and mines, and puts mines in
+    // mine_count_ cells chosen by `rng`.
+    void place_random_mines(Rng& rng);
+
+    // Like place_random_mines(rng), but keeps the mines out of
+    // `first_click` and its neighbours if there's room for them elsewhere.
+    void place_random_mines(Rng& rng, Position first_click);
+
+    // Returns the index in cells_ of a (good) position.
+    size_t index(Board::Position) const;
+
+    // Adds `delta` to the count of adjacent mines of every neighbour of the
+    // cell at an index, for when that cell gains or loses a mine.
+    void add_to_adjacent_counts(size_t, int delta);
+
+    // Finds a cell without a mine that's more than `radius` cells from
+    // `centre` in some direction, at random, or returns false if there
+    // isn't one.
+    bool find_cell_without_mine(Position centre, int radius, Rng& rng,
+                                size_t& found) const;
+
+    // Uncovers the cell at an index, if it's covered, and updates the
+    // counts of covered cells and flags to match.
+    void uncover_cell(size_t);
+
+    // Returns whether the cell at an index is covered, un-flagged and has no
+    // adjacent mines, meaning revealing it spreads to its neighbours.
+    bool is_opening(size_t) const;
 
-    // Returns the number of mines adjacent to one position on the board.
-    size_t mines_adjacent_to_one_pos(Position);
+    // A helper function for reveal. It reveals the cell at an index and,
+    // when that cell has no adjacent mines, flood-fills the opening around
+    // it one row span at a time.
+    void reveal_helper(size_t);
 
-    // Generates an array of valid positions surrounding pos.
-    std::vector<Board::Position> surrounding_positions(Board::Position pos);
+    // Reveals the cells of the rows above or below a span that was just
+    // revealed, from index `first` to index `last`. Cells with no adjacent
+    // mines are added to reveal_seeds_ instead, one per run.
+    void reveal_row_next_to_span(size_t first, size_t last);
 
+    // Returns the number of mines adjacent to one cell on the board.
+    size_t mines_adjacent_to_one_pos(size_t);
 
+    // The two halves of guarantee_adjacent_mines, one for each
+    // Adjacency_engine.
+    void guarantee_adjacent_mines_scalar();
+    void guarantee_adjacent_mines_bitboard();
 };
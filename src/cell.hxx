@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 
 class Cell {
@@ -10,30 +11,93 @@ public:
     // Sets covered_ to false.
     void uncover();
     // Returns whether the Cell is covered.
-    bool is_covered();
+    bool is_covered() const;
     // Sets flag_ to f.
     void set_flag(bool f);
     // Returns whether the Cell is flagged.
-    bool is_flagged();
+    bool is_flagged() const;
     // Sets mine_ to m.
     void set_mine(bool m);
     // Returns whether the Cell contains a mine.
-    bool is_mine();
-    // Sets adjacent_mines_ to num.
+    bool is_mine() const;
+    // Sets adjacent_mines_ to num, which must be between 0 and 8.
     void set_adjacent_mines(size_t num);
     // Returns adjacent_mines_.
-    size_t get_adjacent_mines();
+    size_t get_adjacent_mines() const;
 
-    // Whether a cell is "covered" or "revealed" already.
-    bool covered_;
+private:
+    // Everything about a Cell is packed into a single byte, so a board
+    // costs one byte per cell:
+    //
+    //   bits 0-3: adjacent_mines_, the number of mines adjacent to this
+    //             Cell (0 to 8). Ensuring that this is correct is the
+    //             responsibility of the client.
+    //   bit 4:    covered_, whether a cell is "covered" or "revealed"
+    //             already.
+    //   bit 5:    flag_, whether a cell is "flagged" or not.
+    //   bit 6:    mine_, whether a cell has a mine in it or not.
+    uint8_t bits_;
 
-    // Whether a cell is "flagged" or not.
-    bool flag_;
+    static constexpr uint8_t adjacent_mines_mask_ = 0x0F;
+    static constexpr uint8_t covered_bit_ = 0x10;
+    static constexpr uint8_t flag_bit_ = 0x20;
+    static constexpr uint8_t mine_bit_ = 0x40;
+};
 
-    // Whether a cell has a mine in it or not.
-    bool mine_;
+// The accessors are defined here rather than in cell.cxx so the compiler can
+// inline them into the Board's loops over millions of cells.
 
-    // The number of mines adjacent to this Cell Ensuring that this is
-    // correct is the responsibility of the client.
-    size_t adjacent_mines_;
-};
\ No newline at end of file
+inline void
+Cell::uncover()
+{
+    bits_ &= ~(covered_bit_ | flag_bit_);
+}
+
+
+inline bool
+Cell::is_covered() const
+{
+    return bits_ & covered_bit_;
+}
+
+
+inline void
+Cell::set_flag(bool f)
+{
+    bits_ = f ? (bits_ | flag_bit_) : (bits_ & ~flag_bit_);
+}
+
+
+inline bool
+Cell::is_flagged() const
+{
+    return bits_ & flag_bit_;
+}
+
+
+inline void
+Cell::set_mine(bool m)
+{
+    bits_ = m ? (bits_ | mine_bit_) : (bits_ & ~mine_bit_);
+}
+
+
+inline bool
+Cell::is_mine() const
+{
+    return bits_ & mine_bit_;
+}
+
+
+inline void
+Cell::set_adjacent_mines(size_t num)
+{
+    bits_ = (bits_ & ~adjacent_mines_mask_) | (num & adjacent_mines_mask_);
+}
+
+
+inline size_t
+Cell::get_adjacent_mines() const
+{
+    return bits_ & adjacent_mines_mask_;
+}
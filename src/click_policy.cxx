@@ -0,0 +1,162 @@
+#include "click_policy.hxx"
+
+#include <cstring>
+#include <numeric>
+#include <utility>
+
+void
+Click_policy::new_game(Model const&)
+{ }
+
+
+Random_click_policy::Random_click_policy(uint64_t seed)
+        : rng_(seed),
+          next_(0)
+{ }
+
+
+void
+Random_click_policy::new_game(Model const& model)
+{
+    Model::Dimensions dims = model.get_board_dimensions();
+    // Keeps the vector from game to game, so this only allocates when the
+    // board gets bigger.
+    order_.resize(dims.width * dims.height);
+    std::iota(order_.begin(), order_.end(), 0);
+    next_ = 0;
+}
+
+
+Click_policy::Click
+Random_click_policy::next_click(Model const& model)
+{
+    Model::Dimensions dims = model.get_board_dimensions();
+    Model::Cell_view board = model.get_board();
+    while (next_ < order_.size())
+    {
+        // One more step of a Fisher-Yates shuffle picks the next cell.
+        std::swap(order_[next_],
+                  order_[next_ + rng_.below(order_.size() - next_)]);
+        int i = order_[next_++];
+        Model::Position pos{i % dims.width, i / dims.width};
+        if (board[pos].is_covered() && ! board[pos].is_flagged())
+        {
+            return {pos, false};
+        }
+    }
+    // Nothing is left to reveal, which only happens once the game is over.
+    return {{0, 0}, false};
+}
+
+
+void
+Sweep_click_policy::new_game(Model const&)
+{
+    next_ = 0;
+}
+
+
+Click_policy::Click
+Sweep_click_policy::next_click(Model const& model)
+{
+    Model::Dimensions dims = model.get_board_dimensions();
+    Model::Cell_view board = model.get_board();
+    while (next_ < dims.width * dims.height)
+    {
+        Model::Position pos{next_ % dims.width, next_ / dims.width};
+        next_++;
+        if (board[pos].is_covered() && ! board[pos].is_flagged())
+        {
+            return {pos, false};
+        }
+    }
+    return {{0, 0}, false};
+}
+
+
+Solver_click_policy::Solver_click_policy(uint64_t seed)
+        : rng_(seed),
+          solver_({0, 0}),
+          has_last_(false),
+          last_{0, 0},
+          guesses_(0)
+{ }
+
+
+void
+Solver_click_policy::new_game(Model const& model)
+{
+    solver_.reset(model.get_board_dimensions());
+    // The board may not be all covered, if the game has been played some.
+    solver_.observe_all(model.get_board());
+    has_last_ = false;
+    guesses_ = 0;
+}
+
+
+Click_policy::Click
+Solver_click_policy::reveal(Model::Position pos)
+{
+    has_last_ = true;
+    last_ = pos;
+    return {pos, false};
+}
+
+
+Click_policy::Click
+Solver_click_policy::next_click(Model const& model)
+{
+    Model::Cell_view board = model.get_board();
+    if (has_last_)
+    {
+        solver_.observe(board, last_);
+    }
+
+    // Cells found safe before may have been uncovered since, by an
+    // opening; skip those.
+    Model::Position pos{0, 0};
+    for (int pass = 0; pass < 2; pass++)
+    {
+        while (solver_.next_safe(pos))
+        {
+            if (board[pos].is_covered())
+            {
+                return reveal(pos);
+            }
+        }
+        solver_.deduce();
+    }
+
+    guesses_++;
+    solver_.guess(rng_, pos);
+    return reveal(pos);
+}
+
+
+int
+Solver_click_policy::guesses() const
+{
+    return guesses_;
+}
+
+
+std::unique_ptr<Click_policy>
+make_click_policy(char const* name, uint64_t seed)
+{
+    if (std::strcmp(name, "random") == 0)
+    {
+        return std::unique_ptr<Click_policy>(new Random_click_policy(seed));
+    }
+    else if (std::strcmp(name, "sweep") == 0)
+    {
+        return std::unique_ptr<Click_policy>(new Sweep_click_policy);
+    }
+    else if (std::strcmp(name, "solver") == 0)
+    {
+        return std::unique_ptr<Click_policy>(new Solver_click_policy(seed));
+    }
+    else
+    {
+        return nullptr;
+    }
+}
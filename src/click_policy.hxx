@@ -0,0 +1,95 @@
+#pragma once
+
+#include "model.hxx"
+#include "rng.hxx"
+#include "solver.hxx"
+
+#include <memory>
+#include <vector>
+
+// Decides where a simulated player clicks next. The simulator calls
+// new_game once at the start of every game, and then next_click until the
+// game is over.
+class Click_policy
+{
+public:
+    // One click: a left click reveals `pos`, and a right click flags it.
+    struct Click
+    {
+        Model::Position pos;
+        bool flag;
+    };
+
+    // Gets ready to play the game in `model`.
+    virtual void new_game(Model const& model);
+
+    // Returns the next click to make in the game in `model`.
+    virtual Click next_click(Model const& model) = 0;
+
+    virtual ~Click_policy() = default;
+};
+
+// Reveals a covered cell picked uniformly at random from the ones it
+// hasn't tried yet, and never flags. Each pick takes constant time, since
+// it walks a shuffle of every cell that it makes a step at a time.
+class Random_click_policy : public Click_policy
+{
+public:
+    explicit Random_click_policy(uint64_t seed);
+
+    void new_game(Model const& model) override;
+    Click next_click(Model const& model) override;
+
+private:
+    Rng rng_;
+
+    // Every cell, numbered row by row. The first `next_` of them have been
+    // tried already; the rest haven't been shuffled yet.
+    std::vector<int> order_;
+    size_t next_;
+};
+
+// Reveals every covered cell in order, row by row, and never flags.
+class Sweep_click_policy : public Click_policy
+{
+public:
+    void new_game(Model const& model) override;
+    Click next_click(Model const& model) override;
+
+private:
+    // The number of the next cell to try, row by row.
+    int next_;
+};
+
+// Plays like a careful player: reveals every cell the Solver can prove is
+// safe, and only guesses, at random, when it can't prove anything. It
+// never flags. With play_game, it plays a Model to the end by itself.
+class Solver_click_policy : public Click_policy
+{
+public:
+    explicit Solver_click_policy(uint64_t seed);
+
+    void new_game(Model const& model) override;
+    Click next_click(Model const& model) override;
+
+    // Returns the number of guesses made since new_game.
+    int guesses() const;
+
+private:
+    Rng rng_;
+    Solver solver_;
+
+    // The last cell revealed, whose result the solver hasn't seen yet.
+    bool has_last_;
+    Model::Position last_;
+
+    int guesses_;
+
+    Click reveal(Model::Position);
+};
+
+// Makes the policy called `name` ("random", "sweep" or "solver"), using
+// `seed` if it makes random choices. Returns nullptr if there is no policy
+// with that name.
+std::unique_ptr<Click_policy>
+make_click_policy(char const* name, uint64_t seed);
@@ -1,15 +1,61 @@
 #include "controller.hxx"
 
-Controller::Controller()
-        : view_(model_),
-          mouse_screen_pos(View::Position{0,0})
+Controller::Controller(Game_config const& config)
+        : rng_(Rng::from_entropy()),
+          model_(config, rng_),
+          view_(model_),
+          mouse_screen_pos(View::Position{0,0}),
+          dragging_(false),
+          profile_out_(nullptr)
 { }
 
 
+Controller::Controller(Game_config const& config, uint64_t seed)
+        : rng_(seed),
+          model_(config, rng_),
+          view_(model_),
+          mouse_screen_pos(View::Position{0,0}),
+          dragging_(false),
+          profile_out_(nullptr)
+{ }
+
+
+void
+Controller::profile_frames(std::ostream& out)
+{
+    profile_out_ = &out;
+}
+
+
+void
+Controller::time_frames(std::string const& name)
+{
+    ge211::Frame_timing& timing = record_frame_timing();
+    timing.show_overlay(true);
+    timing.save_on_quit(name + ".csv", name + ".json");
+}
+
+
 void
 Controller::draw(ge211::Sprite_set& set)
 {
+    if (! profile_out_)
+    {
+        view_.draw(set);
+        return;
+    }
+
+    long text_renders = view_.text_renders();
+    profiler_.start();
     view_.draw(set);
+    profiler_.count(view_.text_renders() - text_renders);
+    Frame_profiler::Report report;
+    if (profiler_.stop(report))
+    {
+        *profile_out_ << "draw: " << report.frames << " frames, mean "
+                      << report.mean_ms << " ms, worst " << report.worst_ms
+                      << " ms, " << report.events << " text renders\n";
+    }
 }
 
 
@@ -23,16 +69,75 @@ Controller::initial_window_dimensions() const
 void
 Controller::on_mouse_move(ge211::Posn<int> pos)
 {
+    if (dragging_)
+    {
+        view_.scroll_by({mouse_screen_pos.x - pos.x,
+                         mouse_screen_pos.y - pos.y});
+    }
     mouse_screen_pos = pos;
 }
 
 
+void
+Controller::on_mouse_down(ge211::Mouse_button m, ge211::Posn<int> pos)
+{
+    mouse_screen_pos = pos;
+    if (m == ge211::Mouse_button::middle)
+    {
+        dragging_ = true;
+    }
+}
+
+
+void
+Controller::on_key(ge211::Key key)
+{
+    // How far the arrow keys scroll, in pixels.
+    int const step = 64;
+    if (key == ge211::Key::left())
+    {
+        view_.scroll_by({-step, 0});
+    }
+    else if (key == ge211::Key::right())
+    {
+        view_.scroll_by({step, 0});
+    }
+    else if (key == ge211::Key::up())
+    {
+        view_.scroll_by({0, -step});
+    }
+    else if (key == ge211::Key::down())
+    {
+        view_.scroll_by({0, step});
+    }
+    else if (key == ge211::Key::code('+') || key == ge211::Key::code('='))
+    {
+        view_.zoom(1, mouse_screen_pos);
+    }
+    else if (key == ge211::Key::code('-'))
+    {
+        view_.zoom(-1, mouse_screen_pos);
+    }
+}
+
+
 void
 Controller::on_mouse_up(ge211::Mouse_button m, ge211::Posn<int> pos)
 {
     mouse_screen_pos = pos;
+    if (m == ge211::Mouse_button::middle)
+    {
+        dragging_ = false;
+        return;
+    }
     // Convert the mouse position on the screen to coordinates on the board.
+    // Clicks outside the part of the window that shows the board go to no
+    // cell, since scrolling could put one under them.
     Model::Position mouse_board_pos = view_.screen_to_board(mouse_screen_pos);
+    if (! view_.is_in_board_area(mouse_screen_pos))
+    {
+        mouse_board_pos = Model::Position{-1, -1};
+    }
     // If the Mouse_button passed into the function is the left button,
     // reveal a cell on the board, or reset the game.
     if (m == ge211::Mouse_button::left)
@@ -40,16 +145,23 @@ Controller::on_mouse_up(ge211::Mouse_button m, ge211::Posn<int> pos)
         // Even if the user clicks off the board, it does not throw an
         // exception or generate an error. The reveal function in the model
         // checks that the input is a good position.
+        bool may_have_needed_guessing = model_.may_need_guessing();
         model_.reveal(mouse_board_pos);
+        if (model_.may_need_guessing() && ! may_have_needed_guessing)
+        {
+            std::cerr << "No board that needs no guessing was found for "
+                         "that first click, so this one may need a guess.\n";
+        }
 
-        // If the user clicks the reset button, set the model to its defaults.
+        // If the user clicks the reset button, start a new game with the
+        // same size and number of mines.
         View::Position top_left = view_.get_reset_button_position();
         View::Position bottom_right = top_left + View::Dimensions{60, 60};
         if (mouse_screen_pos.x >= top_left.x && mouse_screen_pos.x <=
         bottom_right.x && mouse_screen_pos.y >= top_left.y &&
         mouse_screen_pos.y <= bottom_right.y)
         {
-            model_ = Model();
+            model_.new_game(rng_);
         }
     }
     // If the Mouse_button passed into the function is the right button, flag
@@ -1,14 +1,34 @@
 #pragma once
 
+#include "frame_profiler.hxx"
 #include "model.hxx"
 #include "view.hxx"
 
 #include <ge211.hxx>
+#include <iostream>
+#include <string>
 
 class Controller : public ge211::Abstract_game
 {
 public:
-    Controller();
+    // Plays games with the given size and number of mines. The reset
+    // button starts a new game with the same Game_config.
+    explicit Controller(Game_config const& config = Game_config());
+
+    // Like the constructor above, but every board, including the ones after
+    // a reset, comes from a generator with the given seed. Playing again
+    // with the same seed gives the same boards in the same order.
+    Controller(Game_config const& config, uint64_t seed);
+
+    // Prints how long drawing takes to `out` every couple of seconds, along
+    // with how many times the counters' text was rendered.
+    void profile_frames(std::ostream& out);
+
+    // Has the game engine time each part of every frame, and the time from
+    // each click to the frame that shows it. A summary is shown on the
+    // screen, and on quitting the last minute's frames are saved to
+    // `name`.csv and, as a trace for Chrome's about://tracing, `name`.json.
+    void time_frames(std::string const& name);
 
 protected:
     // Functions that inherit from Abstract_game. They set up the View.
@@ -16,23 +36,40 @@ protected:
     View::Dimensions initial_window_dimensions() const override;
 
     // These functions are called when particular events happen.
-    // When the mouse moves, the variable mouse_screen_pos is updated.
+    // When the mouse moves, the variable mouse_screen_pos is updated, and
+    // if the middle button is down, the board scrolls along with it.
     void on_mouse_move(ge211::Posn<int> pos) override;
+    // Pressing the middle button starts dragging the board around.
+    void on_mouse_down(ge211::Mouse_button, ge211::Posn<int> pos) override;
     // When the user left-clicks a cell on the board, it reveals the cell.
     // When the user left-clicks the reset button, model_ is set to its
     // defaults.
     // When the user right-clicks a cell on the board, it flags the cell.
     void on_mouse_up(ge211::Mouse_button, ge211::Posn<int> pos) override;
 
+    // The arrow keys scroll the board, and + and - zoom in and out
+    // around the mouse.
+    void on_key(ge211::Key) override;
+
     // The game engine calls this function ever 1/60th of a second. It
     // updates the counter that keeps track of time in the model.
     void on_frame(double dt) override;
 
 private:
+    // Where the mines on every board come from.
+    Rng rng_;
+
     Model model_;
     View view_;
 
     // A variable used in Controller and View that keeps track of the mouse's
     // location on the screen.
     View::Position mouse_screen_pos;
+
+    // Whether the board is being dragged with the middle button.
+    bool dragging_;
+
+    // Times drawing, if profile_frames asked for it.
+    Frame_profiler profiler_;
+    std::ostream* profile_out_;
 };
@@ -0,0 +1,42 @@
+#include "frame_profiler.hxx"
+
+#include <algorithm>
+
+Frame_profiler::Frame_profiler(int frames_per_report)
+        : frames_per_report_(std::max(frames_per_report, 1))
+{ }
+
+
+void
+Frame_profiler::start()
+{
+    started_ = Clock::now();
+}
+
+
+bool
+Frame_profiler::stop(Report& report)
+{
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() -
+                                                          started_)
+            .count();
+    batch_.frames++;
+    batch_.mean_ms += ms;
+    batch_.worst_ms = std::max(batch_.worst_ms, ms);
+    if (batch_.frames < frames_per_report_)
+    {
+        return false;
+    }
+
+    report = batch_;
+    report.mean_ms /= report.frames;
+    batch_ = Report();
+    return true;
+}
+
+
+void
+Frame_profiler::count(long n)
+{
+    batch_.events += n;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+
+// Times a piece of work done once a frame, such as drawing, and sums it up
+// over batches of frames: how long it took on average and at worst, and
+// how many times something costly inside it happened.
+class Frame_profiler
+{
+public:
+    // What one batch of frames took.
+    struct Report
+    {
+        int frames = 0;
+        double mean_ms = 0;
+        double worst_ms = 0;
+
+        // The total passed to count during the batch.
+        long events = 0;
+    };
+
+    // Makes a profiler that finishes a batch every `frames_per_report`
+    // frames.
+    explicit Frame_profiler(int frames_per_report = 120);
+
+    // Starts timing a frame.
+    void start();
+
+    // Stops timing the frame. If that finishes a batch, sets `report` to
+    // what the batch took, starts a new one, and returns true.
+    bool stop(Report& report);
+
+    // Adds `n` events, such as text renders, to the current batch.
+    void count(long n = 1);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    int frames_per_report_;
+    Clock::time_point started_;
+
+    // The batch so far, with the total time instead of the mean.
+    Report batch_;
+};
@@ -0,0 +1,141 @@
+#include "game_config.hxx"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+Game_config::Game_config()
+        : Game_config({30, 16}, 49)
+{ }
+
+Game_config::Game_config(Dimensions dims, int mines)
+        : dims(dims),
+          mines(mines),
+          first_click(First_click::anything),
+          no_guess(false)
+{ }
+
+Game_config
+Game_config::beginner()
+{
+    return {{9, 9}, 10};
+}
+
+Game_config
+Game_config::intermediate()
+{
+    return {{16, 16}, 40};
+}
+
+Game_config
+Game_config::expert()
+{
+    return {{30, 16}, 99};
+}
+
+Game_config
+Game_config::with_density(Dimensions dims, double density)
+{
+    return {dims, int(std::lround(double(dims.width) * dims.height *
+                                  density))};
+}
+
+int64_t const Game_config::max_padded_cells;
+
+bool
+Game_config::is_valid_size(Dimensions dims)
+{
+    return dims.width > 0 && dims.height > 0 &&
+           (int64_t(dims.width) + 2) * (int64_t(dims.height) + 2) <=
+                   max_padded_cells;
+}
+
+int64_t
+Game_config::cells() const
+{
+    return int64_t(dims.width) * dims.height;
+}
+
+double
+Game_config::density() const
+{
+    return cells() > 0 ? double(mines) / double(cells()) : 0;
+}
+
+// Reads a whole number from `arg` into `result`, returning false if it
+// isn't one, or doesn't fit in an `int`.
+static bool
+parse_int(char const* arg, int& result)
+{
+    char* end;
+    errno = 0;
+    long long value = std::strtoll(arg, &end, 10);
+    if (end == arg || *end != '\0' || errno == ERANGE ||
+        value < INT_MIN || value > INT_MAX)
+    {
+        return false;
+    }
+    result = int(value);
+    return true;
+}
+
+bool
+Game_config::parse(std::vector<char const*> const& args, Game_config& config)
+{
+    if (args.empty())
+    {
+        config = Game_config();
+    }
+    else if (args.size() == 1 && std::strcmp(args[0], "beginner") == 0)
+    {
+        config = beginner();
+    }
+    else if (args.size() == 1 && std::strcmp(args[0], "intermediate") == 0)
+    {
+        config = intermediate();
+    }
+    else if (args.size() == 1 && std::strcmp(args[0], "expert") == 0)
+    {
+        config = expert();
+    }
+    else if (args.size() == 3)
+    {
+        Game_config custom;
+        if (! parse_int(args[0], custom.dims.width) ||
+            ! parse_int(args[1], custom.dims.height) ||
+            ! parse_int(args[2], custom.mines) ||
+            ! is_valid_size(custom.dims) || custom.mines < 0)
+        {
+            return false;
+        }
+        config = custom;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool
+Game_config::parse_first_click(char const* name, First_click& first_click)
+{
+    if (std::strcmp(name, "anything") == 0)
+    {
+        first_click = First_click::anything;
+    }
+    else if (std::strcmp(name, "safe") == 0)
+    {
+        first_click = First_click::safe;
+    }
+    else if (std::strcmp(name, "opening") == 0)
+    {
+        first_click = First_click::opening;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
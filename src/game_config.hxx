@@ -0,0 +1,90 @@
+#pragma once
+
+#include <ge211.hxx>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+// The size of a board and the number of mines on it. The presets match the
+// classic difficulty levels; custom games can be any size.
+struct Game_config
+{
+    // Game_config dimensions will use `int` coordinates, as board
+    // dimensions do.
+    using Dimensions = ge211::Dims<int>;
+
+    // The number of columns and rows on the board.
+    Dimensions dims;
+
+    // The number of mines on the board. If it's more than the number of
+    // cells, every cell gets a mine.
+    int mines;
+
+    // What the first reveal of a game is sure to uncover.
+    enum class First_click
+    {
+        // Whatever is there, even a mine, as in the original game.
+        anything,
+        // Never a mine.
+        safe,
+        // A cell with no mines next to it, which opens up an area.
+        opening,
+    };
+
+    // What the first reveal of a game is sure to uncover. Mines in the way
+    // are moved elsewhere when it happens. The default is anything.
+    First_click first_click;
+
+    // Whether the mines should be placed so the whole board can be solved
+    // by logic alone, without guessing, from the first click, which is
+    // then always an opening. Such a board can't be laid out until the
+    // first click is known. Off by default.
+    bool no_guess;
+
+    // The original game: 30 columns, 16 rows and 49 mines.
+    Game_config();
+
+    // Any size and number of mines. A Board can only be made if the size
+    // is valid, as by is_valid_size.
+    Game_config(Dimensions dims, int mines);
+
+    // The most cells a board can have, counting the border one cell wide
+    // around it that Board keeps, since it numbers them with `int`s.
+    static int64_t const max_padded_cells = INT_MAX;
+
+    // Returns whether a board can be this size: at least one column and
+    // row, and no more than max_padded_cells, counting its border.
+    static bool is_valid_size(Dimensions dims);
+
+    // 9 x 9 with 10 mines.
+    static Game_config beginner();
+
+    // 16 x 16 with 40 mines.
+    static Game_config intermediate();
+
+    // 30 x 16 with 99 mines.
+    static Game_config expert();
+
+    // Any size, with mines in the given fraction of its cells (rounded to
+    // the nearest whole mine).
+    static Game_config with_density(Dimensions dims, double density);
+
+    // Returns the number of cells on the board, which doesn't overflow
+    // even if the size isn't valid.
+    int64_t cells() const;
+
+    // Returns the fraction of the cells that have mines.
+    double density() const;
+
+    // Reads a Game_config from command-line arguments: nothing for the
+    // default, a preset name (beginner, intermediate or expert), or a width,
+    // height and number of mines. Returns false if the arguments are none
+    // of those, or the numbers are negative, too big for an `int`, or make
+    // a size that isn't valid, leaving `config` as it was.
+    static bool parse(std::vector<char const*> const& args,
+                      Game_config& config);
+
+    // Reads a First_click from its name: anything, safe or opening. Returns
+    // false if it's none of those, leaving `first_click` as it was.
+    static bool parse_first_click(char const* name, First_click& first_click);
+};
@@ -1,9 +1,85 @@
 #include "controller.hxx"
 
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
 int
-main()
+main(int argc, char* argv[])
 {
-    Controller().run();
+    // `--seed N` makes the same boards every time, `--first-click` says what
+    // the first click is sure to uncover (a safe cell unless it says
+    // otherwise), and `--no-guess` makes boards that can be solved without
+    // guessing. `--profile` prints how long drawing takes, and `--timing
+    // NAME` times every part of each frame, saving the times to NAME.csv
+    // and NAME.json. They can go anywhere.
+    bool seeded = false;
+    bool no_guess = false;
+    bool profile = false;
+    char const* timing = nullptr;
+    bool good_options = true;
+    Game_config::First_click first_click = Game_config::First_click::safe;
+    uint64_t seed = 0;
+    std::vector<char const*> args;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seeded = true;
+            seed = std::strtoull(argv[++i], nullptr, 0);
+        }
+        else if (std::strcmp(argv[i], "--first-click") == 0 && i + 1 < argc)
+        {
+            good_options = good_options &&
+                           Game_config::parse_first_click(argv[++i],
+                                                          first_click);
+        }
+        else if (std::strcmp(argv[i], "--no-guess") == 0)
+        {
+            no_guess = true;
+        }
+        else if (std::strcmp(argv[i], "--profile") == 0)
+        {
+            profile = true;
+        }
+        else if (std::strcmp(argv[i], "--timing") == 0 && i + 1 < argc)
+        {
+            timing = argv[++i];
+        }
+        else
+        {
+            args.push_back(argv[i]);
+        }
+    }
+
+    // With no other arguments, play the original 30 x 16 game with 49
+    // mines.
+    Game_config config;
+    if (! good_options || ! Game_config::parse(args, config))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--seed N]"
+                  << " [--first-click anything|safe|opening] [--no-guess]"
+                  << " [--profile] [--timing NAME]"
+                  << " [beginner | intermediate | expert |"
+                  << " WIDTH HEIGHT MINES]\n";
+        return 1;
+    }
+    config.first_click = first_click;
+    config.no_guess = no_guess;
+
+    std::unique_ptr<Controller> controller(
+            seeded ? new Controller(config, seed) : new Controller(config));
+    if (profile)
+    {
+        controller->profile_frames(std::cerr);
+    }
+    if (timing)
+    {
+        controller->time_frames(timing);
+    }
+    controller->run();
 
     return 0;
 }
@@ -0,0 +1,134 @@
+#include "mine_placement.hxx"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+// Below this fraction of mined cells, rejection sampling rarely has to draw
+// a cell twice, and it keeps up with Floyd's algorithm. (See board_bench.)
+static double const rejection_density = 0.05;
+
+// Above this fraction, so many cells get mines that shuffling an array of
+// every cell is faster than looking cells up in a bitmap.
+static double const fisher_yates_density = 0.15;
+
+
+void
+Mine_placer::choose_fisher_yates(int cells, int mines, Rng& random)
+{
+    if (int(shuffle_.size()) != cells)
+    {
+        shuffle_.resize(cells);
+        std::iota(shuffle_.begin(), shuffle_.end(), 0);
+    }
+    // Swap a random remaining cell into each of the first `mines` places.
+    swaps_.clear();
+    for (int i = 0; i < mines; i++)
+    {
+        int j = random(i, cells - 1);
+        std::swap(shuffle_[i], shuffle_[j]);
+        swaps_.push_back(j);
+    }
+    chosen_.assign(shuffle_.begin(), shuffle_.begin() + mines);
+    // Undo the swaps, last first, so the next call starts from the same
+    // order and gives the same cells for the same random numbers.
+    for (int i = mines - 1; i >= 0; i--)
+    {
+        std::swap(shuffle_[i], shuffle_[swaps_[i]]);
+    }
+}
+
+
+void
+Mine_placer::choose_floyd(int cells, int mines, Rng& random)
+{
+    // Each step picks from one more cell than the last, and takes the
+    // newest cell whenever the pick was already taken.
+    for (int j = cells - mines; j < cells; j++)
+    {
+        int pick = random(0, j);
+        if (marked_[pick])
+        {
+            pick = j;
+        }
+        marked_[pick] = true;
+        chosen_.push_back(pick);
+    }
+}
+
+
+void
+Mine_placer::choose_rejection(int cells, int mines, Rng& random)
+{
+    while (int(chosen_.size()) < mines)
+    {
+        int pick = random(0, cells - 1);
+        if (! marked_[pick])
+        {
+            marked_[pick] = true;
+            chosen_.push_back(pick);
+        }
+    }
+}
+
+
+std::vector<int> const&
+Mine_placer::choose(int cells,
+                    int mines,
+                    Rng& random,
+                    Placement_method method)
+{
+    mines = std::max(0, std::min(mines, cells));
+
+    if (method == Placement_method::automatic)
+    {
+        double density = cells > 0 ? double(mines) / cells : 0;
+        if (density < rejection_density)
+        {
+            method = Placement_method::rejection;
+        }
+        else if (density > fisher_yates_density)
+        {
+            method = Placement_method::fisher_yates;
+        }
+        else
+        {
+            method = Placement_method::floyd;
+        }
+    }
+
+    chosen_.clear();
+    if (method == Placement_method::fisher_yates)
+    {
+        choose_fisher_yates(cells, mines, random);
+        return chosen_;
+    }
+
+    if (int(marked_.size()) < cells)
+    {
+        marked_.resize(cells, false);
+    }
+    if (method == Placement_method::rejection)
+    {
+        choose_rejection(cells, mines, random);
+    }
+    else
+    {
+        choose_floyd(cells, mines, random);
+    }
+    for (int i : chosen_)
+    {
+        marked_[i] = false;
+    }
+    return chosen_;
+}
+
+
+std::vector<int>
+choose_mine_cells(int cells,
+                  int mines,
+                  Rng& random,
+                  Placement_method method)
+{
+    return Mine_placer().choose(cells, mines, random, method);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "rng.hxx"
+
+#include <vector>
+
+// The ways choose_mine_cells can pick which cells get mines. Every method
+// picks each set of cells with the same probability; they only differ in
+// how fast they are for different densities.
+enum class Placement_method
+{
+    // Picks whichever of the methods below suits the density.
+    automatic,
+    // Shuffles the first `mines` entries of an array of every cell. Takes
+    // time and memory in proportion to the number of cells.
+    fisher_yates,
+    // Robert Floyd's sampling algorithm, which draws exactly one random
+    // number per mine and marks the chosen cells in a bitmap.
+    floyd,
+    // Draws random cells until it finds one without a mine yet, marking
+    // them in a bitmap. Fastest when only a small fraction of cells get
+    // mines, and slowest when most of them do.
+    rejection,
+};
+
+// Chooses mine cells like choose_mine_cells below, but keeps its working
+// memory from one call to the next, so making board after board of the same
+// size doesn't allocate anything.
+class Mine_placer
+{
+public:
+    // Chooses `mines` different cells, numbered 0 to `cells - 1`, uniformly
+    // at random, and returns their numbers in no particular order. If there
+    // are more mines than cells, every cell is chosen. The result is only
+    // good until the next call.
+    std::vector<int> const&
+    choose(int cells,
+           int mines,
+           Rng& random,
+           Placement_method method = Placement_method::automatic);
+
+private:
+    // The chosen cells.
+    std::vector<int> chosen_;
+
+    // For fisher_yates: every cell, in order, and the swaps that shuffled
+    // them. The swaps are undone after each call, so the cells only need
+    // filling in again when the number of cells changes.
+    std::vector<int> shuffle_;
+    std::vector<int> swaps_;
+
+    // For floyd and rejection: which cells are chosen. Only the chosen
+    // cells are cleared afterwards, so it stays all false between calls.
+    std::vector<bool> marked_;
+
+    void choose_fisher_yates(int cells, int mines, Rng& random);
+    void choose_floyd(int cells, int mines, Rng& random);
+    void choose_rejection(int cells, int mines, Rng& random);
+};
+
+// Chooses `mines` different cells, numbered 0 to `cells - 1`, uniformly at
+// random, and returns their numbers in no particular order. If there are
+// more mines than cells, every cell is chosen.
+std::vector<int>
+choose_mine_cells(int cells,
+                  int mines,
+                  Rng& random,
+                  Placement_method method = Placement_method::automatic);
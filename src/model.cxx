@@ -1,48 +1,119 @@
 #include "model.hxx"
 
 
-static const int mine_num = 49;
-
-
 Model::Model()
-        : Model(30, 16)
+        : Model(Game_config())
 { }
 
 
 Model::Model(int width, int height)
-        : board(Board({width, height})),
-          flag_counter(mine_num),
+        : Model(Game_config({width, height}, Game_config().mines))
+{ }
+
+
+Model::Model(Game_config const& config)
+        : config(config),
+          board(config),
+          layout_rng(Rng::from_entropy()),
+          flag_counter(board.mine_count()),
+          time(0.),
+          game_over(false),
+          game_started(false),
+          did_you_win(false),
+          may_need_guess(false)
+{ }
+
+
+Model::Model(Game_config const& config, Rng& rng)
+        : config(config),
+          board(config, rng),
+          layout_rng(rng()),
+          flag_counter(board.mine_count()),
           time(0.),
           game_over(false),
           game_started(false),
-          did_you_win(false)
+          did_you_win(false),
+          may_need_guess(false)
 { }
 
 
-std::unordered_map<Model::Position, Cell>
+Model::Cell_view
 Model::get_board() const
 {
     return board.get_board();
 }
 
 
+bool
+Model::changes_since(Journal_cursor& cursor,
+                     std::vector<Position>& changed) const
+{
+    return board.changes_since(cursor, changed);
+}
+
+
+void
+Model::new_game(Rng& rng)
+{
+    board.reset(rng);
+    layout_rng.reseed(rng());
+    flag_counter = board.mine_count();
+    time = 0.;
+    game_over = false;
+    game_started = false;
+    did_you_win = false;
+    may_need_guess = false;
+}
+
+
+Game_config const&
+Model::get_config() const
+{
+    return config;
+}
+
+
 Model::Dimensions
 Model::get_board_dimensions() const
 {
-    return {30, 16};
+    return board.dimensions();
 }
 
 
 void
 Model::reveal(Model::Position pos)
 {
-    // Set game_started to true.
-    game_started = true;
     // Double check that pos is on the board.
     if (! board.good_position(pos))
     {
         return;
     }
+    // Clicks that reveal nothing, on a flagged or uncovered cell, don't
+    // start the game or use up its first click.
+    Cell const& cell = board.get_board()[pos];
+    if (! cell.is_covered() || cell.is_flagged())
+    {
+        return;
+    }
+    // A no-guess board is laid out once the first click is known, and
+    // other boards may need mines moved out of its way.
+    if (! game_started)
+    {
+        if (config.no_guess)
+        {
+            may_need_guess = ! board.reset(layout_rng, pos);
+            update_flag_counter();
+        }
+        else if (config.first_click != Game_config::First_click::anything)
+        {
+            board.move_mines_away(
+                    pos,
+                    config.first_click == Game_config::First_click::opening,
+                    layout_rng);
+        }
+    }
+    // Set game_started to true.
+    game_started = true;
     // If the game isn't over, attempt to reveal cells.
     if (! game_over)
     {
@@ -116,7 +187,7 @@ Model::win()
 void
 Model::update_flag_counter()
 {
-    flag_counter = mine_num - board.get_flag_count();
+    flag_counter = board.mine_count() - board.get_flag_count();
 }
 
 bool
@@ -131,6 +202,12 @@ Model::did_user_win() const
     return did_you_win;
 }
 
+bool
+Model::may_need_guessing() const
+{
+    return may_need_guess;
+}
+
 int
 Model::get_flag_counter() const
 {
@@ -3,6 +3,7 @@
 #include <ge211.hxx>
 #include "board.hxx"
 #include "cell.hxx"
+#include "game_config.hxx"
 
 class Model
 {
@@ -14,24 +15,60 @@ public:
     // Model positions will use `int` coordinates, as board positions do.
     using Position = Board::Position;
 
+    // A read-only view of the cells on the board.
+    using Cell_view = Board::Cell_view;
+
+    // Where a reader of the board's change journal has read up to.
+    using Journal_cursor = Board::Journal_cursor;
+
     // This is the default constructor. Creates a board of 16 rows x 30
-    // columns. Sets the flag counter to 49. Time is set to 0.0.
+    // columns with 49 mines. Sets the flag counter to 49. Time is set to 0.0.
     Model();
 
     // Creates a board with a different number of rows and columns.
     // Everything else is the same as the default constructor.
     Model(int width, int height);
 
-    // Returns the contents of the board.
-    std::unordered_map<Model::Position, Cell>
-    get_board() const;
+    // Creates a board with the size and number of mines of the given
+    // Game_config. Sets the flag counter to the number of mines.
+    explicit Model(Game_config const&);
+
+    // Like the constructor above, but places the mines using `rng`. Models
+    // made from generators with the same seed have the same board.
+    //
+    // If the Game_config asks for a safe first click, mines in its way are
+    // moved on the first reveal. If it asks for no guessing, the mines
+    // aren't placed for real until then, since that's where the board has
+    // to be solvable from.
+    Model(Game_config const&, Rng& rng);
+
+    // Starts a new game with the same Game_config, placing the mines using
+    // `rng`. It gives the same game as making a new Model from `rng`, but
+    // reuses the memory of the old board.
+    void new_game(Rng& rng);
+
+    // Returns the Game_config the Model was made with, so a new game can be
+    // started with the same one.
+    Game_config const& get_config() const;
+
+    // Returns a read-only view of the contents of the board. It does not
+    // copy the board.
+    Cell_view get_board() const;
+
+    // Sets `changed` to the cells of the board that may look different
+    // since `cursor` was last caught up, and returns true, or returns false
+    // if any of them may. See Board::changes_since.
+    bool changes_since(Journal_cursor& cursor,
+                       std::vector<Position>& changed) const;
 
     // Returns the dimensions of the board. These dimensions are the same
     // passed into the constructor when initially creating the Model.
     Dimensions get_board_dimensions() const;
 
     // Uncovers a cell unless the cell is already uncovered, flagged, or the
-    // game is over.
+    // game is over. A position off the board, or a cell it doesn't
+    // uncover, doesn't start the game, so the first click still gets the
+    // treatment the Game_config asks for.
     void reveal(Model::Position);
 
     // Returns whether any cells on the board are uncovered. Utilized for
@@ -51,7 +88,8 @@ public:
     // Updates state when the user has won. It sets game_over to true.
     void win();
 
-    // Updates the flag counter. Manually tallies all flagged cells in board.
+    // Updates the flag counter from the number of flagged cells the board
+    // keeps track of.
     void update_flag_counter();
 
     // Returns whether the game is over.
@@ -60,7 +98,13 @@ public:
     // Returns whether the user won.
     bool did_user_win() const;
 
-    // Returns (99 - c), where c is the number of flagged cells on the board.
+    // Returns whether the Game_config asked for no guessing, but no layout
+    // that needs none was found for the first click in the time there was,
+    // so this game may need a guess after all.
+    bool may_need_guessing() const;
+
+    // Returns (m - c), where m is the number of mines and c is the number of
+    // flagged cells on the board.
     int get_flag_counter() const;
 
     // Gets the number of minutes passed.
@@ -78,12 +122,21 @@ public:
 #endif
 
 private:
-    // Keeps track of each cell. Contains a std::unordered_map with every
-    // cell on the board.
-    Board board;
+    // The size and number of mines of the board.
+    Game_config config;
 
-    // Holds the value (99 - c), where c is the number of flagged cells on the
+    // Keeps track of each cell. Contains a grid with every cell on the
     // board.
+    Board board;
+
+    // The generator for changes made to the board on the first reveal:
+    // moving mines out of the way, or placing them all for a no-guess game.
+    // It's seeded from the generator the game was started with, so the
+    // same seed still gives the same game.
+    Rng layout_rng;
+
+    // Holds the value (m - c), where m is the number of mines and c is the
+    // number of flagged cells on the board.
     int flag_counter;
 
     // Holds the time passed during gameplay.
@@ -98,6 +151,10 @@ private:
     // Whether the user won.
     bool did_you_win;
 
+    // Whether no layout that needs no guessing was found for the first
+    // click of a no-guess game.
+    bool may_need_guess;
+
     // Clear mines on the board
     void clear_mines_on_board();
 
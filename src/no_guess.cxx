@@ -0,0 +1,118 @@
+#include "no_guess.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+bool
+solve_without_guessing(Board& board, Board::Position first_click,
+                       Solver& solver)
+{
+    solver.reset(board.dimensions());
+    if (board.reveal(first_click))
+    {
+        return false;
+    }
+
+    Board::Cell_view view = board.get_board();
+    solver.observe(view, first_click);
+    Board::Position pos{0, 0};
+    for (;;)
+    {
+        solver.deduce();
+        if (! solver.next_safe(pos))
+        {
+            break;
+        }
+        do
+        {
+            board.reveal(pos);
+            solver.observe(view, pos);
+        } while (solver.next_safe(pos));
+    }
+    return board.win();
+}
+
+
+No_guess_generator::Worker::Worker(Game_config const& config)
+        : board(Game_config(config.dims, config.mines)),
+          solver(config.dims)
+{ }
+
+
+No_guess_generator::No_guess_generator(int threads, int64_t max_candidates)
+        : threads_(std::max(threads, 1)),
+          max_candidates_(max_candidates),
+          config_({0, 0}, 0),
+          candidates_checked_(0)
+{ }
+
+
+int64_t
+No_guess_generator::find(Game_config const& config,
+                         Board::Position first_click,
+                         uint64_t seed)
+{
+    // Workers for another size or number of mines can't be reused.
+    if (config.dims != config_.dims || config.mines != config_.mines)
+    {
+        workers_.clear();
+        config_ = config;
+    }
+    while (int(workers_.size()) < threads_)
+    {
+        workers_.emplace_back(config);
+    }
+
+    std::atomic<int64_t> next_candidate(0);
+    std::atomic<int64_t> first_found(max_candidates_);
+    std::atomic<int64_t> checked(0);
+    auto work = [&](Worker& worker) {
+        for (int64_t k; (k = next_candidate++) < first_found.load(); )
+        {
+            Rng rng = Rng::stream(seed, uint64_t(k));
+            worker.board.reset(rng, first_click);
+            checked++;
+            if (solve_without_guessing(worker.board, first_click,
+                                       worker.solver))
+            {
+                // Keep the earliest candidate that works, whichever thread
+                // finds it first.
+                int64_t found = first_found.load();
+                while (k < found &&
+                       ! first_found.compare_exchange_weak(found, k))
+                { }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threads_; t++)
+    {
+        threads.emplace_back(work, std::ref(workers_[t]));
+    }
+    work(workers_[0]);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    candidates_checked_ = checked.load();
+    int64_t found = first_found.load();
+    return found < max_candidates_ ? found : -1;
+}
+
+
+void
+No_guess_generator::set_max_candidates(int64_t max_candidates)
+{
+    max_candidates_ = max_candidates;
+}
+
+
+int64_t
+No_guess_generator::candidates_checked() const
+{
+    return candidates_checked_;
+}
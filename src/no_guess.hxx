@@ -0,0 +1,69 @@
+#pragma once
+
+#include "board.hxx"
+#include "game_config.hxx"
+#include "rng.hxx"
+#include "solver.hxx"
+
+#include <cstdint>
+#include <vector>
+
+// Reveals `first_click` on `board` and then every cell the Solver finds to
+// be safe, until it finds no more. Returns whether that uncovers every cell
+// without a mine, meaning the board can be won from that click without
+// guessing. `solver` is only used as working memory.
+bool
+solve_without_guessing(Board& board, Board::Position first_click,
+                       Solver& solver);
+
+// Finds mine layouts that can be solved without guessing from a given first
+// click. Candidate layouts are made the way Board::reset(rng, first_click)
+// makes them, with an opening at the first click, and the Solver tries each
+// one until one works.
+//
+// Candidate k comes from Rng::stream(seed, k), and the generator returns
+// the first k that works. With several threads, each one takes the next
+// candidate that no thread has tried yet, and they all stop once a
+// candidate before theirs has worked. Some of their work is wasted that
+// way, but the answer is the same on any number of threads.
+class No_guess_generator
+{
+public:
+    // Makes a generator that checks candidates on up to `threads` threads,
+    // and gives up after `max_candidates` of them.
+    explicit No_guess_generator(int threads = 1,
+                                int64_t max_candidates = 10000);
+
+    // Returns the number of the first candidate layout for `config` that
+    // can be solved from `first_click` without guessing, or -1 if none of
+    // the first max_candidates can.
+    int64_t find(Game_config const& config, Board::Position first_click,
+                 uint64_t seed);
+
+    // Changes how many candidates find checks before it gives up.
+    void set_max_candidates(int64_t max_candidates);
+
+    // Returns the number of candidates the last call to find checked, on
+    // every thread, including those checked past the one it returned.
+    int64_t candidates_checked() const;
+
+private:
+    // A board and solver for each thread to check candidates with. They're
+    // kept so that finding board after board of the same size doesn't
+    // allocate.
+    struct Worker
+    {
+        explicit Worker(Game_config const&);
+
+        Board board;
+        Solver solver;
+    };
+
+    int threads_;
+    int64_t max_candidates_;
+
+    // The Game_config the workers were made for.
+    Game_config config_;
+    std::vector<Worker> workers_;
+    int64_t candidates_checked_;
+};
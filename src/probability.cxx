@@ -0,0 +1,643 @@
+#include "probability.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+// A polynomial in the number of mines: entry k is the number of ways (up
+// to a common scale) with k mines.
+using Poly = std::vector<double>;
+
+// A number on the board, as a constraint on the covered cells around it.
+struct Constraint
+{
+    // How many of `cells` have mines.
+    int target;
+
+    // The covered neighbours, as indices into their component's cells.
+    std::vector<int> cells;
+
+    // The first and last of `cells` in the component's order.
+    int first;
+    int last;
+};
+
+// Covered cells that share numbers, and the numbers around them.
+struct Component
+{
+    // The cells, numbered row by row on the board, in the order the
+    // enumeration decides them.
+    std::vector<int> cells;
+
+    std::vector<Constraint> constraints;
+};
+
+// The result of enumerating a component.
+struct Component_ways
+{
+    // ways[k] is the number of arrangements with k mines, scaled so the
+    // biggest is 1.
+    Poly ways;
+
+    // mine_ways[i][k] is the number of those arrangements with a mine in
+    // cell i, on the same scale.
+    std::vector<Poly> mine_ways;
+
+    int widest_state = 0;
+    size_t most_states = 0;
+};
+
+// Returns `a` times `b`, as polynomials, scaled by `scale`, added into
+// `out` at an offset of `shift` mines.
+void
+add_product(Poly const& a, Poly const& b, int shift, double scale, Poly& out)
+{
+    if (out.size() < a.size() + b.size() - 1 + shift)
+    {
+        out.resize(a.size() + b.size() - 1 + shift, 0);
+    }
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        if (a[i] == 0)
+        {
+            continue;
+        }
+        for (size_t j = 0; j < b.size(); j++)
+        {
+            out[i + j + shift] += scale * a[i] * b[j];
+        }
+    }
+}
+
+// Adds `p` into `out` at an offset of `shift` mines.
+void
+add_shifted(Poly const& p, int shift, Poly& out)
+{
+    if (out.size() < p.size() + shift)
+    {
+        out.resize(p.size() + shift, 0);
+    }
+    for (size_t i = 0; i < p.size(); i++)
+    {
+        out[i + shift] += p[i];
+    }
+}
+
+// Scales a polynomial so its biggest entry is 1, and returns the log of
+// what it was divided by. Leaves an all-zero polynomial alone.
+double
+normalize(Poly& p)
+{
+    double biggest = 0;
+    for (double x : p)
+    {
+        biggest = std::max(biggest, x);
+    }
+    if (biggest == 0)
+    {
+        return 0;
+    }
+    for (double& x : p)
+    {
+        x /= biggest;
+    }
+    return std::log(biggest);
+}
+
+// One step of the enumeration of a component: deciding cell i. The states
+// before and after it list how many mines each partly decided constraint
+// has so far, in the order of `before` and `after`.
+struct Step
+{
+    // For each constraint in the state after this cell: where it was in the
+    // state before (or -1 if it starts here), and whether this cell is one
+    // of its cells.
+    std::vector<int> from;
+    std::vector<bool> adds;
+
+    // For each constraint this cell is one of: where it was in the state
+    // before (or -1), how many mines it needs, and how many of its cells
+    // come after this one.
+    struct Check
+    {
+        int from;
+        int target;
+        int cells_after;
+    };
+    std::vector<Check> checks;
+};
+
+// Works out the state after deciding a cell to be `mine` from the state
+// `before`, or returns false if that breaks a constraint.
+bool
+take_step(Step const& step, std::string const& before, int mine,
+          std::string& after)
+{
+    for (Step::Check const& check : step.checks)
+    {
+        int mines = (check.from < 0 ? 0 : before[check.from]) + mine;
+        if (mines > check.target || mines + check.cells_after < check.target)
+        {
+            return false;
+        }
+    }
+    after.resize(step.from.size());
+    for (size_t k = 0; k < step.from.size(); k++)
+    {
+        int mines = step.from[k] < 0 ? 0 : before[step.from[k]];
+        after[k] = char(mines + (step.adds[k] ? mine : 0));
+    }
+    return true;
+}
+
+// Counts the arrangements of mines in a component, in total and with a
+// mine in each cell, by number of mines.
+Component_ways
+enumerate(Component const& component)
+{
+    int n = int(component.cells.size());
+
+    // Which constraints each cell is one of, and which constraints are
+    // partly decided before each step.
+    std::vector<std::vector<int>> cell_constraints(n);
+    for (size_t c = 0; c < component.constraints.size(); c++)
+    {
+        for (int i : component.constraints[c].cells)
+        {
+            cell_constraints[i].push_back(int(c));
+        }
+    }
+    std::vector<std::vector<int>> active(n + 1);
+    for (size_t c = 0; c < component.constraints.size(); c++)
+    {
+        Constraint const& constraint = component.constraints[c];
+        for (int i = constraint.first + 1; i <= constraint.last; i++)
+        {
+            active[i].push_back(int(c));
+        }
+    }
+
+    std::vector<Step> steps(n);
+    for (int i = 0; i < n; i++)
+    {
+        auto slot_before = [&](int c) {
+            auto found = std::find(active[i].begin(), active[i].end(), c);
+            return found == active[i].end()
+                   ? -1 : int(found - active[i].begin());
+        };
+        for (int c : active[i + 1])
+        {
+            steps[i].from.push_back(slot_before(c));
+            steps[i].adds.push_back(
+                    std::find(cell_constraints[i].begin(),
+                              cell_constraints[i].end(), c) !=
+                    cell_constraints[i].end());
+        }
+        for (int c : cell_constraints[i])
+        {
+            Constraint const& constraint = component.constraints[c];
+            int cells_after = 0;
+            for (int j : constraint.cells)
+            {
+                cells_after += j > i;
+            }
+            steps[i].checks.push_back({slot_before(c), constraint.target,
+                                       cells_after});
+        }
+    }
+
+    Component_ways result;
+
+    // Forward: for each state before each step, the number of ways to
+    // decide the cells so far, by number of mines. Each layer is scaled to
+    // keep the numbers in range, and the logs of the scales are kept.
+    using Layer = std::unordered_map<std::string, Poly>;
+    std::vector<Layer> forward(n + 1);
+    std::vector<double> forward_scale(n + 1, 0);
+    forward[0][std::string()] = Poly{1};
+    std::string after;
+    for (int i = 0; i < n; i++)
+    {
+        for (auto const& entry : forward[i])
+        {
+            for (int mine = 0; mine <= 1; mine++)
+            {
+                if (take_step(steps[i], entry.first, mine, after))
+                {
+                    add_shifted(entry.second, mine, forward[i + 1][after]);
+                }
+            }
+        }
+        double biggest = 0;
+        for (auto const& entry : forward[i + 1])
+        {
+            for (double x : entry.second)
+            {
+                biggest = std::max(biggest, x);
+            }
+        }
+        if (biggest > 0)
+        {
+            for (auto& entry : forward[i + 1])
+            {
+                for (double& x : entry.second)
+                {
+                    x /= biggest;
+                }
+            }
+            forward_scale[i + 1] = forward_scale[i] + std::log(biggest);
+        }
+        result.widest_state = std::max(result.widest_state,
+                                       int(active[i + 1].size()));
+        result.most_states = std::max(result.most_states,
+                                      forward[i + 1].size());
+    }
+
+    // Backward: for each state reached before each step, the number of
+    // ways to decide the rest of the cells, by number of mines.
+    std::vector<Layer> backward(n + 1);
+    std::vector<double> backward_scale(n + 1, 0);
+    backward[n][std::string()] = Poly{1};
+    result.mine_ways.resize(n);
+    for (int i = n - 1; i >= 0; i--)
+    {
+        Poly& mine_here = result.mine_ways[i];
+        for (auto const& entry : forward[i])
+        {
+            Poly& ways = backward[i][entry.first];
+            for (int mine = 0; mine <= 1; mine++)
+            {
+                if (! take_step(steps[i], entry.first, mine, after))
+                {
+                    continue;
+                }
+                auto rest = backward[i + 1].find(after);
+                if (rest == backward[i + 1].end())
+                {
+                    continue;
+                }
+                add_shifted(rest->second, mine, ways);
+                if (mine)
+                {
+                    add_product(entry.second, rest->second, 1, 1.0,
+                                mine_here);
+                }
+            }
+        }
+        // mine_here is on the scale of forward[i] times backward[i + 1];
+        // keep the log of that until the total is known.
+        backward_scale[i] = backward_scale[i + 1];
+        double biggest = 0;
+        for (auto const& entry : backward[i])
+        {
+            for (double x : entry.second)
+            {
+                biggest = std::max(biggest, x);
+            }
+        }
+        if (biggest > 0)
+        {
+            for (auto& entry : backward[i])
+            {
+                for (double& x : entry.second)
+                {
+                    x /= biggest;
+                }
+            }
+            backward_scale[i] += std::log(biggest);
+        }
+        // Free the layers that are done with.
+        Layer().swap(backward[i + 1]);
+        Layer().swap(forward[i + 1]);
+    }
+
+    result.ways = backward[0][std::string()];
+    double ways_scale = backward_scale[0] + normalize(result.ways);
+    for (int i = 0; i < n; i++)
+    {
+        double scale = std::exp(forward_scale[i] + backward_scale[i + 1] -
+                                ways_scale);
+        for (double& x : result.mine_ways[i])
+        {
+            x *= scale;
+        }
+    }
+    return result;
+}
+
+// Returns the log of the number of ways to choose k of n things, or -inf
+// if there are none.
+double
+log_choose(double n, double k)
+{
+    if (k < 0 || k > n)
+    {
+        return -std::numeric_limits<double>::infinity();
+    }
+    return std::lgamma(n + 1) - std::lgamma(k + 1) - std::lgamma(n - k + 1);
+}
+
+}  // end anonymous namespace
+
+
+Probability_engine::Probability_engine(int threads)
+        : threads_(std::max(threads, 1))
+{ }
+
+
+Probability_engine::Info const&
+Probability_engine::info() const
+{
+    return info_;
+}
+
+
+bool
+Probability_engine::compute(Board::Cell_view board, int mines,
+                            Probability_grid& out)
+{
+    Board::Dimensions dims = board.dimensions();
+    int width = dims.width;
+    int cells = width * dims.height;
+    out.dims = dims;
+    out.cells.assign(cells, 0);
+    info_ = Info();
+
+    auto position = [=](int i) {
+        return Board::Position{i % width, i / width};
+    };
+    auto is_number = [&](int i) {
+        Cell const& c = board[position(i)];
+        return ! c.is_covered() && ! c.is_mine();
+    };
+    // Calls f on each neighbour of cell i that's on the board.
+    auto for_neighbours = [&](int i, auto f) {
+        int x = i % width;
+        int y = i / width;
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                if ((dx != 0 || dy != 0) && x + dx >= 0 && x + dx < width &&
+                    y + dy >= 0 && y + dy < dims.height)
+                {
+                    f((y + dy) * width + x + dx);
+                }
+            }
+        }
+    };
+
+    // Find the frontier, and split it into components that share no
+    // numbers, in an order that keeps each number's cells close together.
+    std::vector<int> component_of(cells, -1);
+    std::vector<Component> components;
+    std::vector<int> interior;
+    std::vector<int> to_visit;
+    for (int start = 0; start < cells; start++)
+    {
+        if (! board[position(start)].is_covered() ||
+            component_of[start] >= 0)
+        {
+            continue;
+        }
+        bool frontier = false;
+        for_neighbours(start, [&](int j) {
+            frontier = frontier || is_number(j);
+        });
+        if (! frontier)
+        {
+            interior.push_back(start);
+            continue;
+        }
+
+        int id = int(components.size());
+        components.emplace_back();
+        Component& component = components.back();
+        component_of[start] = id;
+        to_visit.assign(1, start);
+        for (size_t next = 0; next < to_visit.size(); next++)
+        {
+            int i = to_visit[next];
+            component.cells.push_back(i);
+            for_neighbours(i, [&](int number) {
+                if (! is_number(number))
+                {
+                    return;
+                }
+                for_neighbours(number, [&](int j) {
+                    if (board[position(j)].is_covered() &&
+                        component_of[j] < 0)
+                    {
+                        component_of[j] = id;
+                        to_visit.push_back(j);
+                    }
+                });
+            });
+        }
+    }
+
+    // Every number with covered neighbours constrains exactly one
+    // component. Local cell numbers come from each cell's place in its
+    // component.
+    std::vector<int> local(cells, -1);
+    for (Component& component : components)
+    {
+        for (size_t k = 0; k < component.cells.size(); k++)
+        {
+            local[component.cells[k]] = int(k);
+        }
+    }
+    for (int i = 0; i < cells; i++)
+    {
+        if (! is_number(i))
+        {
+            continue;
+        }
+        Constraint constraint;
+        constraint.target = int(board[position(i)].get_adjacent_mines());
+        int id = -1;
+        for_neighbours(i, [&](int j) {
+            if (board[position(j)].is_covered())
+            {
+                id = component_of[j];
+                constraint.cells.push_back(local[j]);
+            }
+        });
+        if (id < 0)
+        {
+            if (constraint.target != 0)
+            {
+                return false;
+            }
+            continue;
+        }
+        constraint.first = *std::min_element(constraint.cells.begin(),
+                                             constraint.cells.end());
+        constraint.last = *std::max_element(constraint.cells.begin(),
+                                            constraint.cells.end());
+        components[id].constraints.push_back(std::move(constraint));
+    }
+
+    // Enumerate the components, biggest first, on as many threads as
+    // there are components to go around.
+    std::vector<size_t> by_size(components.size());
+    for (size_t c = 0; c < components.size(); c++)
+    {
+        by_size[c] = c;
+    }
+    std::sort(by_size.begin(), by_size.end(), [&](size_t a, size_t b) {
+        return components[a].cells.size() > components[b].cells.size();
+    });
+    std::vector<Component_ways> ways(components.size());
+    std::atomic<size_t> next_component(0);
+    auto work = [&] {
+        for (size_t k; (k = next_component++) < by_size.size(); )
+        {
+            ways[by_size[k]] = enumerate(components[by_size[k]]);
+        }
+    };
+    std::vector<std::thread> workers;
+    int extra_threads = std::min(threads_, int(components.size())) - 1;
+    for (int t = 0; t < extra_threads; t++)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    info_.components = int(components.size());
+    info_.interior_cells = int(interior.size());
+    for (size_t c = 0; c < components.size(); c++)
+    {
+        int size = int(components[c].cells.size());
+        info_.frontier_cells += size;
+        info_.largest_component = std::max(info_.largest_component, size);
+        info_.widest_state = std::max(info_.widest_state,
+                                      ways[c].widest_state);
+        info_.most_states = std::max(info_.most_states,
+                                     ways[c].most_states);
+    }
+
+    // weights[t] is proportional to the number of ways to put the mines
+    // not in the frontier in the interior, if the frontier has t mines.
+    int frontier = info_.frontier_cells;
+    double unconstrained = info_.interior_cells;
+    std::vector<double> log_weights(frontier + 1);
+    double biggest_log = -std::numeric_limits<double>::infinity();
+    for (int t = 0; t <= frontier; t++)
+    {
+        log_weights[t] = log_choose(unconstrained, mines - t);
+        biggest_log = std::max(biggest_log, log_weights[t]);
+    }
+    if (std::isinf(biggest_log))
+    {
+        return false;
+    }
+    Poly weights(frontier + 1);
+    for (int t = 0; t <= frontier; t++)
+    {
+        weights[t] = std::exp(log_weights[t] - biggest_log);
+    }
+
+    // rest[c][t] is proportional to the number of ways to fill components
+    // c, c + 1, ... and the interior, if the components before c have t
+    // mines. It's built from the last component back.
+    size_t m = components.size();
+    std::vector<Poly> rest(m + 1);
+    rest[m] = weights;
+    for (size_t c = m; c-- > 0; )
+    {
+        Poly const& ways_c = ways[c].ways;
+        Poly const& after = rest[c + 1];
+        size_t length = after.size() - (ways_c.size() - 1);
+        rest[c].assign(length, 0);
+        for (size_t t = 0; t < length; t++)
+        {
+            for (size_t k = 0; k < ways_c.size(); k++)
+            {
+                rest[c][t] += ways_c[k] * after[t + k];
+            }
+        }
+        normalize(rest[c]);
+    }
+
+    // Go through the components in order, keeping `before`, the ways to
+    // fill the components so far by number of mines.
+    Poly before{1};
+    for (size_t c = 0; c < m; c++)
+    {
+        Poly const& ways_c = ways[c].ways;
+        Poly const& after = rest[c + 1];
+
+        // other[k]: the ways to fill everything but this component, if it
+        // has k mines.
+        Poly other(ways_c.size(), 0);
+        for (size_t k = 0; k < ways_c.size(); k++)
+        {
+            for (size_t a = 0; a < before.size(); a++)
+            {
+                other[k] += before[a] * after[a + k];
+            }
+        }
+        double total = 0;
+        for (size_t k = 0; k < ways_c.size(); k++)
+        {
+            total += ways_c[k] * other[k];
+        }
+        if (total == 0)
+        {
+            out.cells.assign(cells, 0);
+            return false;
+        }
+        Component const& component = components[c];
+        for (size_t i = 0; i < component.cells.size(); i++)
+        {
+            Poly const& mine_ways = ways[c].mine_ways[i];
+            double with_mine = 0;
+            for (size_t k = 0; k < mine_ways.size(); k++)
+            {
+                with_mine += mine_ways[k] * other[k];
+            }
+            out.cells[component.cells[i]] = with_mine / total;
+        }
+
+        Poly next;
+        add_product(before, ways_c, 0, 1.0, next);
+        normalize(next);
+        before.swap(next);
+    }
+
+    // Every interior cell has the same chance: the expected number of
+    // mines left over for the interior, over the number of its cells.
+    if (! interior.empty())
+    {
+        double total = 0;
+        double interior_mines = 0;
+        for (size_t t = 0; t < before.size(); t++)
+        {
+            double w = before[t] * weights[t];
+            total += w;
+            interior_mines += w * (mines - double(t));
+        }
+        if (total == 0)
+        {
+            out.cells.assign(cells, 0);
+            return false;
+        }
+        double chance = interior_mines / total / unconstrained;
+        for (int i : interior)
+        {
+            out.cells[i] = chance;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "board.hxx"
+
+#include <cstdint>
+#include <vector>
+
+// The chance of a mine in each cell of a board, row by row.
+struct Probability_grid
+{
+    // Probability_grid dimensions will use `int` coordinates, as board
+    // dimensions do.
+    using Dimensions = Board::Dimensions;
+
+    // Probability_grid positions will use `int` coordinates, as board
+    // positions do.
+    using Position = Board::Position;
+
+    Dimensions dims{0, 0};
+
+    // The probability for each cell, row by row. Uncovered cells get 0.
+    std::vector<double> cells;
+
+    // Returns the probability for a (good) position.
+    double operator[](Position pos) const
+    {
+        return cells[size_t(pos.y) * dims.width + pos.x];
+    }
+};
+
+// Computes the exact probability that each covered cell has a mine, given
+// what a player can see and the total number of mines, with every
+// arrangement of mines that fits the numbers equally likely. Flags are
+// ignored, since they might be wrong.
+//
+// The covered cells next to a number (the frontier) are split into
+// components that share no numbers, since each one's mines can be counted
+// separately. Each component is enumerated with a dynamic program over its
+// cells, one at a time, memoising on how many mines each number that is
+// partly decided has so far; that counts every arrangement of its mines
+// without listing them. The components are then combined, weighting each
+// total number of frontier mines by the number of ways to put the rest in
+// the unconstrained cells, which is a binomial coefficient.
+//
+// The components can be enumerated on several threads at once. Combining
+// them takes time in proportion to the square of the size of the frontier,
+// which is fine for boards up to a few hundred cells across.
+class Probability_engine
+{
+public:
+    // What the last call to compute found.
+    struct Info
+    {
+        // The number of components, and the number of cells in the
+        // biggest one.
+        int components = 0;
+        int largest_component = 0;
+
+        // The number of covered cells next to a number, and the number of
+        // covered cells that aren't.
+        int frontier_cells = 0;
+        int interior_cells = 0;
+
+        // The most partly decided numbers any component had to remember at
+        // once, and the most states it had to remember at one cell.
+        int widest_state = 0;
+        size_t most_states = 0;
+    };
+
+    // Makes an engine that enumerates components on up to `threads` threads.
+    explicit Probability_engine(int threads = 1);
+
+    // Computes the probability of a mine in every cell of `board`, if it
+    // has `mines` mines in all. Returns false, and leaves every probability
+    // at 0, if no arrangement of that many mines fits the numbers.
+    bool compute(Board::Cell_view board, int mines, Probability_grid& out);
+
+    // Returns what the last call to compute found.
+    Info const& info() const;
+
+private:
+    int threads_;
+    Info info_;
+};
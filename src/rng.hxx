@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <random>
+
+// A small, fast pseudo-random number generator (xoshiro256**) for making
+// boards. Two Rngs made with the same seed produce the same numbers on every
+// computer, so a board made from a seed can be made again bit for bit.
+//
+// It meets the requirements of a uniform random bit generator, so it also
+// works with the distributions in <random>.
+class Rng
+{
+public:
+    using result_type = uint64_t;
+
+    // Makes a generator whose numbers are determined by `seed`.
+    explicit Rng(uint64_t seed)
+    {
+        reseed(seed);
+    }
+
+    // Makes a generator with a seed nobody can predict.
+    static Rng
+    from_entropy()
+    {
+        std::random_device device;
+        return Rng(uint64_t(device()) << 32 | device());
+    }
+
+    // Makes generator number `stream` of a family of generators that share
+    // a seed. Each stream gives different numbers, so work split into many
+    // pieces can give each piece its own stream, and get the same results
+    // however the pieces are shared out between threads.
+    static Rng
+    stream(uint64_t seed, uint64_t stream)
+    {
+        // Mixing the stream number in once more keeps streams of nearby
+        // seeds from overlapping.
+        Rng mixer(stream);
+        return Rng(seed ^ mixer());
+    }
+
+    // Starts the sequence over from a new seed. The four words of state are
+    // filled in with splitmix64, so even seeds like 0 and 1 give good
+    // sequences.
+    void
+    reseed(uint64_t seed)
+    {
+        for (uint64_t& word : state_)
+        {
+            seed += 0x9E3779B97F4A7C15;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    // Returns the next 64 random bits.
+    result_type
+    operator()()
+    {
+        uint64_t result = rotate_left(state_[1] * 5, 7) * 9;
+        uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotate_left(state_[3], 45);
+        return result;
+    }
+
+    // Returns a random int from `lo` to `hi`, inclusive, each with the same
+    // probability. This is the same call as ge211::Random_source<int>'s.
+    int
+    operator()(int lo, int hi)
+    {
+        return lo + int(below(uint64_t(int64_t(hi) - lo) + 1));
+    }
+
+    // Returns a random number from 0 to `bound - 1`, with no bias. Uses
+    // Lemire's multiply-and-shift method where the compiler has 128-bit
+    // integers, which usually needs no division.
+    uint64_t
+    below(uint64_t bound)
+    {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 product = (unsigned __int128) (*this)() * bound;
+        uint64_t low = uint64_t(product);
+        if (low < bound)
+        {
+            uint64_t threshold = -bound % bound;
+            while (low < threshold)
+            {
+                product = (unsigned __int128) (*this)() * bound;
+                low = uint64_t(product);
+            }
+        }
+        return uint64_t(product >> 64);
+#else
+        // Throw away the few lowest numbers that would make some results more
+        // likely than others.
+        uint64_t threshold = -bound % bound;
+        uint64_t x;
+        do
+        {
+            x = (*this)();
+        } while (x < threshold);
+        return x % bound;
+#endif
+    }
+
+    static constexpr result_type
+    min()
+    {
+        return 0;
+    }
+
+    static constexpr result_type
+    max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+private:
+    uint64_t state_[4];
+
+    static uint64_t
+    rotate_left(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+};
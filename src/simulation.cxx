@@ -0,0 +1,369 @@
+#include "simulation.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// A range of chunk numbers, from `begin` up to but not including `end`,
+// packed into one word so it can be changed with one compare-and-swap.
+uint64_t
+pack_chunks(uint64_t begin, uint64_t end)
+{
+    return begin << 32 | end;
+}
+
+uint64_t
+chunks_begin(uint64_t range)
+{
+    return range >> 32;
+}
+
+uint64_t
+chunks_end(uint64_t range)
+{
+    return range & 0xFFFFFFFF;
+}
+
+// The chunks a thread has left to play. Its owner takes them from the
+// front, and other threads steal them from the back. It fills a whole cache
+// line, so threads working on their own chunks don't slow each other down.
+struct Chunk_queue
+{
+    std::atomic<uint64_t> range;
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+};
+
+// Takes the first chunk from a queue. Returns false if it's empty.
+bool
+take_chunk(Chunk_queue& queue, uint64_t& chunk)
+{
+    uint64_t range = queue.range.load();
+    while (chunks_begin(range) < chunks_end(range))
+    {
+        if (queue.range.compare_exchange_weak(
+                range,
+                pack_chunks(chunks_begin(range) + 1, chunks_end(range))))
+        {
+            chunk = chunks_begin(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Moves the back half of the chunks of some other thread's queue into the
+// (empty) queue of thread `thief`. Returns false if every queue is empty,
+// which means there is nothing left to steal, ever: chunks only move
+// between queues, and a queue only grows while its owner's is empty.
+//
+// The begin of a range only goes up and the end only goes down, except
+// when a range is refilled with chunks nobody else has seen, so a
+// compare-and-swap can never mistake one range for another.
+bool
+steal_chunks(std::vector<Chunk_queue>& queues, size_t thief)
+{
+    for (size_t k = 1; k < queues.size(); k++)
+    {
+        Chunk_queue& victim = queues[(thief + k) % queues.size()];
+        uint64_t range = victim.range.load();
+        while (chunks_begin(range) < chunks_end(range))
+        {
+            uint64_t begin = chunks_begin(range);
+            uint64_t end = chunks_end(range);
+            uint64_t middle = end - (end - begin + 1) / 2;
+            if (victim.range.compare_exchange_weak(range,
+                                                   pack_chunks(begin,
+                                                               middle)))
+            {
+                queues[thief].range.store(pack_chunks(middle, end));
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Plays the chunks of one thread, stealing more when it runs out, and
+// returns what happened.
+Sim_stats
+run_worker(Game_config const& config,
+           uint64_t games,
+           uint64_t chunk_games,
+           Click_policy_factory const& make_policy,
+           uint64_t seed,
+           std::vector<Chunk_queue>& queues,
+           size_t id)
+{
+    Sim_stats stats;
+    // The first game of every chunk starts over from the chunk's stream,
+    // so the Rng this Model is made with doesn't matter.
+    Rng rng(seed);
+    Model model(config, rng);
+
+    for (;;)
+    {
+        uint64_t chunk;
+        if (! take_chunk(queues[id], chunk))
+        {
+            if (steal_chunks(queues, id))
+            {
+                continue;
+            }
+            return stats;
+        }
+
+        rng = Rng::stream(seed, chunk);
+        std::unique_ptr<Click_policy> policy = make_policy(rng());
+        uint64_t first = chunk * chunk_games;
+        uint64_t last = std::min(games, first + chunk_games);
+        for (uint64_t game = first; game < last; game++)
+        {
+            model.new_game(rng);
+            play_game(model, *policy, stats);
+        }
+    }
+}
+
+}  // end anonymous namespace
+
+Latency_histogram::Latency_histogram()
+        : counts_(),
+          count_(0),
+          max_(0)
+{ }
+
+
+int
+Latency_histogram::bucket_of(uint64_t ns)
+{
+    if (ns < uint64_t(sub_buckets))
+    {
+        return int(ns);
+    }
+    // Find the highest set bit, then use the four bits below it to pick
+    // one of the 16 buckets for that power of two.
+    int exponent = 4;
+    while (ns >> (exponent + 1))
+    {
+        exponent++;
+    }
+    int sub = int(ns >> (exponent - 4)) & (sub_buckets - 1);
+    return sub_buckets + (exponent - 4) * sub_buckets + sub;
+}
+
+
+uint64_t
+Latency_histogram::bucket_start(int bucket)
+{
+    if (bucket < sub_buckets)
+    {
+        return uint64_t(bucket);
+    }
+    int exponent = 4 + (bucket - sub_buckets) / sub_buckets;
+    uint64_t sub = uint64_t(bucket % sub_buckets);
+    return (uint64_t(sub_buckets) + sub) << (exponent - 4);
+}
+
+
+void
+Latency_histogram::record(uint64_t ns)
+{
+    counts_[bucket_of(ns)]++;
+    count_++;
+    max_ = std::max(max_, ns);
+}
+
+
+void
+Latency_histogram::merge(Latency_histogram const& other)
+{
+    for (int b = 0; b < buckets; b++)
+    {
+        counts_[b] += other.counts_[b];
+    }
+    count_ += other.count_;
+    max_ = std::max(max_, other.max_);
+}
+
+
+uint64_t
+Latency_histogram::count() const
+{
+    return count_;
+}
+
+
+uint64_t
+Latency_histogram::percentile(double p) const
+{
+    if (count_ == 0)
+    {
+        return 0;
+    }
+    // The rank of the time we want, counting from 1.
+    uint64_t rank = std::max(uint64_t(1),
+                             uint64_t(p / 100 * double(count_) + 0.5));
+    if (rank >= count_)
+    {
+        return max_;
+    }
+    uint64_t seen = 0;
+    for (int b = 0; b < buckets; b++)
+    {
+        seen += counts_[b];
+        if (seen >= rank)
+        {
+            return std::min(bucket_start(b), max_);
+        }
+    }
+    return max_;
+}
+
+
+uint64_t
+Latency_histogram::max() const
+{
+    return max_;
+}
+
+
+void
+Sim_stats::merge(Sim_stats const& other)
+{
+    games += other.games;
+    wins += other.wins;
+    stalls += other.stalls;
+    clicks += other.clicks;
+    reveal_ns.merge(other.reveal_ns);
+    seconds = std::max(seconds, other.seconds);
+}
+
+
+bool
+play_game(Model& model, Click_policy& policy, Sim_stats& stats)
+{
+    Model::Dimensions dims = model.get_board_dimensions();
+    uint64_t click_limit = 4 * uint64_t(dims.width) * dims.height + 16;
+
+    policy.new_game(model);
+    stats.games++;
+    for (uint64_t clicks = 0; ! model.is_game_over(); clicks++)
+    {
+        if (clicks == click_limit)
+        {
+            stats.stalls++;
+            return false;
+        }
+
+        Click_policy::Click click = policy.next_click(model);
+        stats.clicks++;
+        if (click.flag)
+        {
+            model.flag(click.pos);
+        }
+        else
+        {
+            Clock::time_point start = Clock::now();
+            model.reveal(click.pos);
+            Clock::time_point end = Clock::now();
+            stats.reveal_ns.record(uint64_t(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            end - start).count()));
+        }
+    }
+
+    if (model.did_user_win())
+    {
+        stats.wins++;
+        return true;
+    }
+    return false;
+}
+
+
+Sim_stats
+simulate(Game_config const& config,
+         uint64_t games,
+         Click_policy& policy,
+         Rng& rng)
+{
+    Sim_stats stats;
+    Clock::time_point start = Clock::now();
+    Model model(config, rng);
+    for (uint64_t game = 0; game < games; game++)
+    {
+        // Reusing one Model gives the same games as making a new one each
+        // time, without allocating a new board.
+        if (game > 0)
+        {
+            model.new_game(rng);
+        }
+        play_game(model, policy, stats);
+    }
+    stats.seconds =
+            std::chrono::duration<double>(Clock::now() - start).count();
+    return stats;
+}
+
+
+Sim_stats
+simulate_parallel(Game_config const& config,
+                  uint64_t games,
+                  int threads,
+                  Click_policy_factory const& make_policy,
+                  uint64_t seed,
+                  uint64_t chunk_games)
+{
+    threads = std::max(threads, 1);
+    chunk_games = std::max(chunk_games, uint64_t(1));
+    uint64_t chunks = (games + chunk_games - 1) / chunk_games;
+    // Chunk numbers have to fit in half a word.
+    if (chunks > 0xFFFFFFFF)
+    {
+        chunk_games = (games + 0xFFFFFFFE) / 0xFFFFFFFF;
+        chunks = (games + chunk_games - 1) / chunk_games;
+    }
+
+    // Deal the chunks out evenly to start with.
+    std::vector<Chunk_queue> queues(threads);
+    for (int i = 0; i < threads; i++)
+    {
+        queues[i].range.store(pack_chunks(chunks * i / threads,
+                                          chunks * (i + 1) / threads));
+    }
+
+    Clock::time_point start = Clock::now();
+
+    // This thread is worker 0, and the others each get a thread of their
+    // own. Each one keeps its own stats until the end.
+    std::vector<Sim_stats> results(threads);
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; i++)
+    {
+        workers.emplace_back([&, i] {
+            results[i] = run_worker(config, games, chunk_games, make_policy,
+                                    seed, queues, i);
+        });
+    }
+    results[0] = run_worker(config, games, chunk_games, make_policy, seed,
+                            queues, 0);
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    Sim_stats total;
+    for (Sim_stats const& result : results)
+    {
+        total.merge(result);
+    }
+    total.seconds =
+            std::chrono::duration<double>(Clock::now() - start).count();
+    return total;
+}
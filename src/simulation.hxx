@@ -0,0 +1,113 @@
+#pragma once
+
+#include "click_policy.hxx"
+#include "game_config.hxx"
+#include "model.hxx"
+#include "rng.hxx"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+// Counts how many times took how long, in nanoseconds, without storing every
+// time. Each power of two is split into 16 buckets, so a percentile comes
+// out within about 6% of the real time. Adding two histograms together gives
+// the histogram of both sets of times.
+class Latency_histogram
+{
+public:
+    Latency_histogram();
+
+    // Counts one time.
+    void record(uint64_t ns);
+
+    // Adds the counts of another histogram to this one.
+    void merge(Latency_histogram const&);
+
+    // Returns the number of times counted.
+    uint64_t count() const;
+
+    // Returns the time that `p` percent of the times are no longer than,
+    // rounded down to the start of its bucket. Returns 0 if nothing has
+    // been counted.
+    uint64_t percentile(double p) const;
+
+    // Returns the longest time counted.
+    uint64_t max() const;
+
+private:
+    // Times under 16 ns get a bucket each; every power of two from 16 up
+    // gets 16.
+    static int const sub_buckets = 16;
+    static int const buckets = sub_buckets + 60 * sub_buckets;
+
+    std::array<uint64_t, buckets> counts_;
+    uint64_t count_;
+    uint64_t max_;
+
+    // Returns the bucket that counts `ns`.
+    static int bucket_of(uint64_t ns);
+
+    // Returns the smallest time that goes in a bucket.
+    static uint64_t bucket_start(int bucket);
+};
+
+// What happened over a batch of simulated games.
+struct Sim_stats
+{
+    // The number of games played, won, and given up on because the policy
+    // kept clicking without finishing the game.
+    uint64_t games = 0;
+    uint64_t wins = 0;
+    uint64_t stalls = 0;
+
+    // The number of clicks made, and how long each reveal took.
+    uint64_t clicks = 0;
+    Latency_histogram reveal_ns;
+
+    // The wall-clock time the games took, including making the boards.
+    double seconds = 0;
+
+    // Adds up the stats of two batches that were played at the same time,
+    // so the time taken is the longer of the two.
+    void merge(Sim_stats const&);
+};
+
+// Plays one game in `model` until it's over, making the clicks `policy`
+// asks for, and adds what happened to `stats`. Gives up after many more
+// clicks than there are cells. Returns whether the game was won.
+bool
+play_game(Model& model, Click_policy& policy, Sim_stats& stats);
+
+// Plays `games` games with the given size and number of mines, making the
+// boards from `rng` and clicking where `policy` says.
+Sim_stats
+simulate(Game_config const& config,
+         uint64_t games,
+         Click_policy& policy,
+         Rng& rng);
+
+// Makes a Click_policy for one piece of a parallel simulation, seeded with
+// the given number if it uses random numbers.
+using Click_policy_factory =
+        std::function<std::unique_ptr<Click_policy>(uint64_t seed)>;
+
+// Plays `games` games across `threads` threads, and adds up what happened.
+//
+// The games are split into chunks of `chunk_games`. Each thread starts
+// with an equal share of the chunks, and a thread that runs out steals half
+// of the remaining chunks of another thread, so threads that get slow games
+// don't hold up the others. Taking and stealing chunks is lock-free.
+//
+// Each chunk makes its boards from its own Rng stream and its own policy,
+// both seeded from `seed` and the chunk number, so the results are the same
+// for any number of threads. Each thread reuses one Model for all its games
+// and keeps its own Sim_stats, which are only added up at the end.
+Sim_stats
+simulate_parallel(Game_config const& config,
+                  uint64_t games,
+                  int threads,
+                  Click_policy_factory const& make_policy,
+                  uint64_t seed,
+                  uint64_t chunk_games = 64);
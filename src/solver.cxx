@@ -0,0 +1,422 @@
+#include "solver.hxx"
+
+#include <algorithm>
+
+// The width of the window that the unknown neighbours of two nearby
+// constraints are compared in, and the bit of the cell at its centre.
+static int const window_width = 7;
+static int const window_centre = 3 * window_width + 3;
+
+// The width of the border around the solver's grid. The subset rule looks
+// at constraints up to two cells away, so it needs two.
+static int const padding = 2;
+
+// Returns the number of bits set in a window mask.
+static int
+count_bits(uint64_t bits)
+{
+    int count = 0;
+    for (; bits != 0; bits &= bits - 1)
+    {
+        count++;
+    }
+    return count;
+}
+
+Solver::Solver(Dimensions dims)
+        : dims_{0, 0},
+          stride_(0)
+{
+    reset(dims);
+}
+
+
+void
+Solver::reset(Dimensions dims)
+{
+    dims_ = dims;
+    stride_ = dims.width + 2 * padding;
+
+    // Every cell starts out unknown, and the border starts out seen, with
+    // a count that makes it never a constraint.
+    state_.assign(size_t(stride_) * (dims.height + 2 * padding),
+                  seen | border_count);
+    for (int y = 0; y < dims.height; y++)
+    {
+        uint8_t* row = &state_[index({0, y})];
+        std::fill(row, row + dims.width, 0);
+    }
+
+    int k = 0;
+    for (int dy = -1; dy <= 1; dy++)
+    {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            if (dx != 0 || dy != 0)
+            {
+                neighbour_offsets_[k] = dy * stride_ + dx;
+                neighbour_window_bits_[k] =
+                        window_centre + dy * window_width + dx;
+                k++;
+            }
+        }
+    }
+
+    work_.clear();
+    new_safe_.clear();
+    new_mines_.clear();
+}
+
+
+size_t
+Solver::index(Position pos) const
+{
+    return size_t(pos.y + padding) * stride_ + (pos.x + padding);
+}
+
+
+Solver::Position
+Solver::position(size_t i) const
+{
+    return {int(i % stride_) - padding, int(i / stride_) - padding};
+}
+
+
+bool
+Solver::is_unknown(size_t i) const
+{
+    return (state_[i] & (seen | known_safe | known_mine)) == 0;
+}
+
+
+bool
+Solver::is_constraint(size_t i) const
+{
+    return (state_[i] & seen) && (state_[i] & count_mask) != border_count;
+}
+
+
+void
+Solver::observe_all(Board::Cell_view board)
+{
+    for (int y = 0; y < dims_.height; y++)
+    {
+        for (int x = 0; x < dims_.width; x++)
+        {
+            size_t i = index({x, y});
+            if (! (state_[i] & seen) && ! board[{x, y}].is_covered())
+            {
+                see(i, board);
+            }
+        }
+    }
+}
+
+
+void
+Solver::observe(Board::Cell_view board, Position pos)
+{
+    size_t start = index(pos);
+    if ((state_[start] & seen) || board[pos].is_covered())
+    {
+        return;
+    }
+
+    // The cells uncovered by one reveal are all connected, so a search
+    // from the revealed cell through uncovered cells it hasn't seen finds
+    // every one of them, and nothing else.
+    see(start, board);
+    to_observe_.clear();
+    to_observe_.push_back(start);
+    while (! to_observe_.empty())
+    {
+        size_t i = to_observe_.back();
+        to_observe_.pop_back();
+        for (int offset : neighbour_offsets_)
+        {
+            size_t j = i + offset;
+            if (! (state_[j] & seen) && ! board[position(j)].is_covered())
+            {
+                see(j, board);
+                to_observe_.push_back(j);
+            }
+        }
+    }
+}
+
+
+void
+Solver::see(size_t i, Board::Cell_view const& board)
+{
+    uint8_t count = uint8_t(board[position(i)].get_adjacent_mines());
+    state_[i] = uint8_t((state_[i] & ~count_mask) | seen | count);
+    // This cell is a new constraint, and it's one fewer unknown neighbour
+    // for the constraints around it.
+    enqueue(i);
+    for (int offset : neighbour_offsets_)
+    {
+        if (is_constraint(i + offset))
+        {
+            enqueue(i + offset);
+        }
+    }
+}
+
+
+void
+Solver::enqueue(size_t i)
+{
+    if (! (state_[i] & queued))
+    {
+        state_[i] |= queued;
+        work_.push_back(i);
+    }
+}
+
+
+void
+Solver::mark(size_t i, bool mine)
+{
+    if (! is_unknown(i))
+    {
+        return;
+    }
+    state_[i] |= mine ? known_mine : known_safe;
+    (mine ? new_mines_ : new_safe_).push_back(i);
+    for (int offset : neighbour_offsets_)
+    {
+        if (is_constraint(i + offset))
+        {
+            enqueue(i + offset);
+        }
+    }
+}
+
+
+void
+Solver::mark_window(size_t centre, uint64_t window, bool mine)
+{
+    for (; window != 0; window &= window - 1)
+    {
+        int bit = 0;
+        while (! ((window >> bit) & 1))
+        {
+            bit++;
+        }
+        int dx = bit % window_width - 3;
+        int dy = bit / window_width - 3;
+        mark(centre + dy * stride_ + dx, mine);
+    }
+}
+
+
+uint64_t
+Solver::unknown_window(size_t i, int dx, int dy, int& remaining) const
+{
+    uint64_t window = 0;
+    remaining = state_[i] & count_mask;
+    for (int k = 0; k < 8; k++)
+    {
+        size_t j = i + neighbour_offsets_[k];
+        if (state_[j] & known_mine)
+        {
+            remaining--;
+        }
+        else if (is_unknown(j))
+        {
+            window |= uint64_t(1)
+                    << (neighbour_window_bits_[k] + dy * window_width + dx);
+        }
+    }
+    return window;
+}
+
+
+void
+Solver::check(size_t a)
+{
+    int a_remaining;
+    uint64_t a_unknown = unknown_window(a, 0, 0, a_remaining);
+    if (a_unknown == 0)
+    {
+        return;
+    }
+
+    // Single point rule.
+    if (a_remaining == 0)
+    {
+        mark_window(a, a_unknown, false);
+        return;
+    }
+    if (a_remaining == count_bits(a_unknown))
+    {
+        mark_window(a, a_unknown, true);
+        return;
+    }
+
+    // Subset rule, against every constraint close enough to share an
+    // unknown neighbour.
+    for (int dy = -2; dy <= 2; dy++)
+    {
+        for (int dx = -2; dx <= 2; dx++)
+        {
+            size_t b = a + dy * stride_ + dx;
+            if ((dx == 0 && dy == 0) || ! is_constraint(b))
+            {
+                continue;
+            }
+
+            int b_remaining;
+            uint64_t b_unknown = unknown_window(b, dx, dy, b_remaining);
+            if (b_unknown == a_unknown || (b_unknown & a_unknown) == 0)
+            {
+                continue;
+            }
+
+            if ((a_unknown & ~b_unknown) == 0)
+            {
+                // A's unknowns are inside B's.
+                uint64_t rest = b_unknown & ~a_unknown;
+                int mines = b_remaining - a_remaining;
+                if (mines == 0 || mines == count_bits(rest))
+                {
+                    mark_window(a, rest, mines != 0);
+                }
+            }
+            else if ((b_unknown & ~a_unknown) == 0)
+            {
+                // B's unknowns are inside A's.
+                uint64_t rest = a_unknown & ~b_unknown;
+                int mines = a_remaining - b_remaining;
+                if (mines == 0 || mines == count_bits(rest))
+                {
+                    mark_window(a, rest, mines != 0);
+                }
+            }
+        }
+    }
+}
+
+
+void
+Solver::deduce()
+{
+    while (! work_.empty())
+    {
+        size_t i = work_.back();
+        work_.pop_back();
+        state_[i] &= uint8_t(~queued);
+        check(i);
+    }
+}
+
+
+bool
+Solver::next_safe(Position& pos)
+{
+    if (new_safe_.empty())
+    {
+        return false;
+    }
+    pos = position(new_safe_.back());
+    new_safe_.pop_back();
+    return true;
+}
+
+
+bool
+Solver::next_mine(Position& pos)
+{
+    if (new_mines_.empty())
+    {
+        return false;
+    }
+    pos = position(new_mines_.back());
+    new_mines_.pop_back();
+    return true;
+}
+
+
+bool
+Solver::is_seen(Position pos) const
+{
+    return (state_[index(pos)] & seen) != 0;
+}
+
+
+bool
+Solver::is_known_safe(Position pos) const
+{
+    return (state_[index(pos)] & known_safe) != 0;
+}
+
+
+bool
+Solver::is_known_mine(Position pos) const
+{
+    return (state_[index(pos)] & known_mine) != 0;
+}
+
+
+bool
+Solver::guess(Rng& rng, Position& pos)
+{
+    int cells = dims_.width * dims_.height;
+    if (cells == 0)
+    {
+        return false;
+    }
+
+    // Usually most cells are unknown, so a few random tries find one.
+    for (int tries = 0; tries < 32; tries++)
+    {
+        int n = rng(0, cells - 1);
+        Position p{n % dims_.width, n / dims_.width};
+        if (is_unknown(index(p)))
+        {
+            pos = p;
+            return true;
+        }
+    }
+
+    // Otherwise take the first unknown cell from a random starting point.
+    int start = rng(0, cells - 1);
+    for (int k = 0; k < cells; k++)
+    {
+        int n = (start + k) % cells;
+        Position p{n % dims_.width, n / dims_.width};
+        if (is_unknown(index(p)))
+        {
+            pos = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+int
+Solver::frontier_size() const
+{
+    int frontier = 0;
+    for (int y = 0; y < dims_.height; y++)
+    {
+        for (int x = 0; x < dims_.width; x++)
+        {
+            size_t i = index({x, y});
+            if (! is_constraint(i))
+            {
+                continue;
+            }
+            for (int offset : neighbour_offsets_)
+            {
+                if (is_unknown(i + offset))
+                {
+                    frontier++;
+                    break;
+                }
+            }
+        }
+    }
+    return frontier;
+}
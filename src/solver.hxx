@@ -0,0 +1,154 @@
+#pragma once
+
+#include "board.hxx"
+#include "rng.hxx"
+
+#include <cstdint>
+#include <vector>
+
+// Works out which covered cells are certainly safe and which certainly have
+// mines, using only what a player can see: which cells are uncovered, and
+// the numbers on them. It never looks at where the mines really are.
+//
+// Every uncovered cell with covered neighbours is a constraint: its number,
+// less the mines already known around it, is how many of its unknown
+// neighbours have mines. The solver applies two rules to them:
+//
+//  - Single point: if a constraint needs no more mines, all its unknown
+//    neighbours are safe; if it needs as many mines as it has unknown
+//    neighbours, they are all mines.
+//
+//  - Subset: if the unknown neighbours of constraint A are a subset of
+//    those of constraint B, then the rest of B's unknown neighbours hold
+//    exactly the difference of their mine counts. If that's 0 they are all
+//    safe, and if it's all of them they are all mines.
+//
+// The unknown neighbours of two constraints up to two cells apart fit in a
+// 7 x 7 window around the first, so they're compared as 49-bit masks.
+//
+// The solver remembers what it has seen and deduced, and only looks at the
+// constraints around cells that change, so solving a game one click at a
+// time takes time in proportion to the size of the board overall.
+class Solver
+{
+public:
+    // Solver positions will use `int` coordinates, as board positions do.
+    using Position = Board::Position;
+
+    // Solver dimensions will use `int` coordinates, as board dimensions do.
+    using Dimensions = Board::Dimensions;
+
+    // Makes a solver for a board with the given dimensions, on which
+    // nothing has been seen yet.
+    explicit Solver(Dimensions dims);
+
+    // Forgets everything, ready for a new board of the given dimensions.
+    // Reuses the memory it has if the size is the same.
+    void reset(Dimensions dims);
+
+    // Notes every uncovered cell on `board` that the solver hasn't seen
+    // yet. Takes time in proportion to the size of the board.
+    void observe_all(Board::Cell_view board);
+
+    // Notes the cells uncovered by revealing `pos`: that cell and, if it
+    // was an opening, every cell uncovered along with it. Takes time in
+    // proportion to the number of cells uncovered.
+    void observe(Board::Cell_view board, Position pos);
+
+    // Applies the rules to every constraint that may have changed, until
+    // nothing more follows.
+    void deduce();
+
+    // Hands out the next cell found to be safe, or returns false if there
+    // are no more for now. Each cell is handed out once.
+    bool next_safe(Position&);
+
+    // Hands out the next cell found to have a mine, or returns false if
+    // there are no more for now. Each cell is handed out once.
+    bool next_mine(Position&);
+
+    // Returns whether a cell has been seen uncovered.
+    bool is_seen(Position) const;
+
+    // Returns whether a cell has been found to be safe.
+    bool is_known_safe(Position) const;
+
+    // Returns whether a cell has been found to have a mine.
+    bool is_known_mine(Position) const;
+
+    // Picks a covered cell that isn't known to be safe or a mine, at
+    // random, for when the rules can't find anything. Returns false if
+    // there isn't one.
+    bool guess(Rng& rng, Position&);
+
+    // Returns the number of uncovered cells that still have unknown
+    // neighbours. The board must be observed and deduced first.
+    int frontier_size() const;
+
+private:
+    // What the solver knows about each cell. It is stored in a padded
+    // grid, like Board's but with a border two cells wide, so every cell
+    // has neighbours out to two cells away.
+    enum : uint8_t
+    {
+        // Bits 0-3 hold the number on a seen cell. Border cells have
+        // `border_count`, which no real cell can have.
+        count_mask = 0x0F,
+        border_count = 0x0F,
+        seen = 0x10,
+        known_safe = 0x20,
+        known_mine = 0x40,
+        queued = 0x80,
+    };
+
+    Dimensions dims_;
+    int stride_;
+    std::vector<uint8_t> state_;
+
+    // The offsets from a cell's index to the indices of its eight
+    // neighbours, and where each neighbour lands in a 7 x 7 window
+    // centred on the cell.
+    int neighbour_offsets_[8];
+    int neighbour_window_bits_[8];
+
+    // The constraints waiting to be looked at, and the cells found but not
+    // handed out yet.
+    std::vector<size_t> work_;
+    std::vector<size_t> new_safe_;
+    std::vector<size_t> new_mines_;
+
+    // Scratch space for observe.
+    std::vector<size_t> to_observe_;
+
+    size_t index(Position) const;
+    Position position(size_t) const;
+
+    // Returns whether the cell at an index could be a mine or safe, as far
+    // as the solver knows.
+    bool is_unknown(size_t) const;
+
+    // Returns whether the cell at an index is a seen, numbered cell.
+    bool is_constraint(size_t) const;
+
+    // Records what's at a cell the board shows uncovered, and queues it and
+    // the constraints around it.
+    void see(size_t, Board::Cell_view const& board);
+
+    // Adds a constraint to the work list, unless it's there already.
+    void enqueue(size_t);
+
+    // Records that a cell is safe or has a mine, and queues the
+    // constraints around it.
+    void mark(size_t, bool mine);
+
+    // Marks every cell in a 7 x 7 window mask around `centre`.
+    void mark_window(size_t centre, uint64_t window, bool mine);
+
+    // Returns the unknown neighbours of the constraint at `i` as a mask of
+    // a 7 x 7 window centred `dx` and `dy` cells to its left and above it,
+    // and sets `remaining` to the number of mines among them.
+    uint64_t unknown_window(size_t i, int dx, int dy, int& remaining) const;
+
+    // Applies both rules to one constraint.
+    void check(size_t);
+};
@@ -0,0 +1,94 @@
+#include "tile_tracker.hxx"
+
+#include <algorithm>
+
+// What handed_out_ holds for a cell that needs handing out whatever its
+// tile is.
+static Tile_tracker::Tile const not_handed_out = Tile_tracker::Tile(0xFF);
+
+Tile_tracker::Tile
+Tile_tracker::tile_of(Cell const& cell)
+{
+    if (cell.is_covered())
+    {
+        return cell.is_flagged() ? Tile::flagged : Tile::covered;
+    }
+    else if (cell.is_mine())
+    {
+        return Tile::mine;
+    }
+    else
+    {
+        return Tile(cell.get_adjacent_mines());
+    }
+}
+
+
+bool
+Tile_tracker::update(Model const& model, Rectangle cells,
+                     std::vector<Update>& updates)
+{
+    updates.clear();
+    if (cells != region_)
+    {
+        region_ = cells;
+        handed_out_.assign(size_t(cells.width) * cells.height,
+                           not_handed_out);
+        cursor_ = Model::Journal_cursor();
+    }
+
+    Model::Cell_view board = model.get_board();
+    if (model.changes_since(cursor_, changed_))
+    {
+        for (Position pos : changed_)
+        {
+            if (pos.x >= region_.x && pos.x < region_.x + region_.width &&
+                pos.y >= region_.y && pos.y < region_.y + region_.height)
+            {
+                check(pos, board[pos], updates);
+            }
+        }
+        return false;
+    }
+
+    for (int y = region_.y; y < region_.y + region_.height; y++)
+    {
+        for (int x = region_.x; x < region_.x + region_.width; x++)
+        {
+            check({x, y}, board[{x, y}], updates);
+        }
+    }
+    return true;
+}
+
+
+bool
+Tile_tracker::update(Model const& model, std::vector<Update>& updates)
+{
+    Model::Dimensions dims = model.get_board_dimensions();
+    return update(model, {0, 0, dims.width, dims.height}, updates);
+}
+
+
+void
+Tile_tracker::forget()
+{
+    std::fill(handed_out_.begin(), handed_out_.end(), not_handed_out);
+    // A new cursor makes the next update look at the whole board.
+    cursor_ = Model::Journal_cursor();
+}
+
+
+void
+Tile_tracker::check(Position pos, Cell const& cell,
+                    std::vector<Update>& updates)
+{
+    Tile tile = tile_of(cell);
+    Tile& handed_out = handed_out_[size_t(pos.y - region_.y) *
+                                   region_.width + (pos.x - region_.x)];
+    if (tile != handed_out)
+    {
+        handed_out = tile;
+        updates.push_back({pos, tile});
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "model.hxx"
+
+#include <cstdint>
+#include <vector>
+
+// Works out which picture, or tile, each cell of the board should be drawn
+// with, and which cells need drawing again because their tile changed. It
+// remembers the tile it last handed out for each cell, and reads the
+// board's change journal to find the cells that may have changed since, so
+// when nothing happens it does next to nothing.
+class Tile_tracker
+{
+public:
+    // Tile_tracker positions will use `int` coordinates, as board
+    // positions do.
+    using Position = Model::Position;
+
+    // The pictures a cell can be drawn with. Tile(n), for n from 0 to 8, is
+    // the tile of an uncovered cell with n adjacent mines.
+    enum class Tile : uint8_t
+    {
+        empty, one, two, three, four, five, six, seven, eight,
+        covered, flagged, mine,
+    };
+
+    // A cell whose tile changed, and its new tile.
+    struct Update
+    {
+        Position pos;
+        Tile tile;
+    };
+
+    // Returns the tile a cell should be drawn with.
+    static Tile tile_of(Cell const&);
+
+    // A rectangle of cells.
+    using Rectangle = ge211::Rect<int>;
+
+    // Sets `updates` to every cell in the rectangle `cells` of `model`'s
+    // board whose tile is different from the one handed out for it last
+    // time, each once. The first time, after forget, and when the
+    // rectangle changes, that's every cell in it. Returns whether every
+    // cell in the rectangle had to be looked at, rather than just the
+    // cells in the change journal. The rectangle must be on the board.
+    bool update(Model const& model, Rectangle cells,
+                std::vector<Update>& updates);
+
+    // Like the function above, for every cell of the board.
+    bool update(Model const& model, std::vector<Update>& updates);
+
+    // Forgets the tiles handed out, so that the next update hands out every
+    // cell again, for when whatever they were drawn on is lost.
+    void forget();
+
+private:
+    // The tile last handed out for each cell of region_, row by row.
+    std::vector<Tile> handed_out_;
+    Rectangle region_{0, 0, 0, 0};
+
+    Model::Journal_cursor cursor_;
+
+    // Scratch space for the cells in the change journal.
+    std::vector<Position> changed_;
+
+    // Hands out the tile of a cell, if it's different from the last one.
+    void check(Position, Cell const&, std::vector<Update>&);
+};
@@ -1,164 +1,201 @@
 #include "view.hxx"
 
+#include <algorithm>
+#include <limits>
+#include <string>
+
 // Constants
 static int const cell_size = 32;
+// Small boards still get a window wide enough for the counters and the
+// reset button.
+static int const min_window_width = 10 * cell_size;
 static ge211::Color const background_color {128, 128, 128};
+// Boards that don't fit in this many pixels are shown a part at a time.
+static View::Dimensions const max_board_area {1280, 768};
+// The image for each Tile_tracker::Tile, in order.
+static std::vector<std::string> const tile_images {
+        "empty-cell.png", "one-cell.png", "two-cell.png", "three-cell.png",
+        "four-cell.png", "five-cell.png", "six-cell.png", "seven-cell.png",
+        "eight-cell.png", "covered-cell.png", "flagged-cell.png",
+        "mine-cell.png"};
+
+
+// Returns the dimensions of the part of the window that shows the board.
+static View::Dimensions
+board_area_dimensions(Model const& model)
+{
+    View::Dimensions dims = cell_size * model.get_board_dimensions();
+    return {std::min(dims.width, max_board_area.width),
+            std::min(dims.height, max_board_area.height)};
+}
 
 
 View::View(Model const& model)
         : model_(model),
-          background_{initial_window_dimensions(), background_color}
+          background_{initial_window_dimensions(), background_color},
+          tile_atlas_{tile_images},
+          shown_flags_(std::numeric_limits<int>::min()),
+          shown_seconds_(-1),
+          text_renders_(0),
+          viewport_(model.get_board_dimensions(),
+                    board_area_dimensions(model),
+                    cell_size),
+          viewport_moved_(true),
+          board_canvas_{board_area_dimensions(model), background_color}
 { }
 
 
 void
 View::draw(ge211::Sprite_set& set)
 {
-    // Set the background.
-    set.add_sprite(background_, {0, 0}, 0);
-    // Get the board from the Model.
-    std::unordered_map<Model::Position, Cell> board = model_.get_board();
-    // Draw every cell.
-    for (auto p : board)
+    // The sprites are retained in the set the first time, and after that
+    // they're only changed or moved, which saves adding them every frame.
+    if (! background_handle_)
+    {
+        background_handle_ = set.retain_sprite(background_, {0, 0}, 0);
+        board_handle_ = set.retain_sprite(board_canvas_, {2, 2}, 1);
+        reset_button_handle_ = set.retain_sprite(
+                default_smiley_, get_reset_button_position(), 1);
+        flag_counter_handle_ = set.retain_sprite(flag_counter_, {0, 0}, 3);
+        time_counter_handle_ = set.retain_sprite(time_counter, {0, 0}, 3);
+    }
+
+    // Draw the cells whose tiles changed onto the picture of the board, or
+    // every cell the window shows if the picture was lost or the viewport
+    // moved. When nothing happens, nothing is drawn, however big the board
+    // is, and however much happens, no more than a screenful is drawn.
+    if (board_canvas_.check_lost() || viewport_moved_)
+    {
+        board_canvas_.clear();
+        tiles_.forget();
+        viewport_moved_ = false;
+    }
+    tiles_.update(model_, viewport_.visible_cells(), tile_updates_);
+    ge211::Transform scale =
+            ge211::Transform::scale(double(viewport_.cell_size()) /
+                                    cell_size);
+    for (Tile_tracker::Update const& update : tile_updates_)
+    {
+        board_canvas_.draw(tile_sprite(update.tile),
+                           viewport_.board_to_screen(update.pos),
+                           scale);
+    }
+
+    // Show the reset button depending on game state.
+    if (! model_.is_game_over())
+    {
+        set.change_sprite(reset_button_handle_, default_smiley_);
+    }
+    else if (model_.did_user_win())
+    {
+        set.change_sprite(reset_button_handle_, win_smiley_);
+    }
+    else
+    {
+        set.change_sprite(reset_button_handle_, lose_smiley_);
+    }
+    // Keep the Flag Counter and Time Counter text sprites centered, as
+    // their text changes.
+    update_counters();
+    set.move_sprite(flag_counter_handle_, get_flag_counter_position());
+    set.move_sprite(time_counter_handle_, get_time_counter_position());
+}
+
+
+void
+View::update_counters()
+{
+    int flags = model_.get_flag_counter();
+    if (flags != shown_flags_)
     {
-        if (p.second.is_covered())
-        {
-            if (p.second.is_flagged())
-            {
-                set.add_sprite(flagged_cell_,
-                               board_to_screen(p.first),
-                               1);
-            }
-            else
-            {
-                set.add_sprite(covered_cell_,
-                               board_to_screen(p.first),
-                               1);
-            }
-        }
-        else if (p.second.is_mine())
-        {
-            set.add_sprite(mine_cell_,
-                           board_to_screen(p.first),
-                           1);
-        }
-        else if (p.second.get_adjacent_mines() == 0)
-        {
-            set.add_sprite(empty_cell_,
-                           board_to_screen(p.first),
-                           1);
-        }
-        else if (p.second.get_adjacent_mines() == 1)
-        {
-            set.add_sprite(one_cell_,
-                           board_to_screen(p.first),
-                           1);
-        }
-        else if (p.second.get_adjacent_mines() == 2)
-        {
-            set.add_sprite(two_cell_,
-                           board_to_screen(p.first),
-                           1);
-        }
-        else if (p.second.get_adjacent_mines() == 3)
-        {
-            set.add_sprite(three_cell_,
-                           board_to_screen(p.first),
-                           1);
-        }
-        else if (p.second.get_adjacent_mines() == 4)
-        {
-            set.add_sprite(four_cell_,
-                           board_to_screen(p.first),
-                           1);
-        }
-        else if (p.second.get_adjacent_mines() == 5)
-        {
-            set.add_sprite(five_cell_,
-                           board_to_screen(p.first),
-                           1);
-        }
-        else if (p.second.get_adjacent_mines() == 6)
-        {
-            set.add_sprite(six_cell_,
-                           board_to_screen(p.first),
-                           1);
-        }
-        else if (p.second.get_adjacent_mines() == 7)
-        {
-            set.add_sprite(seven_cell_,
-                           board_to_screen(p.first),
-                           1);
-        }
-        else if (p.second.get_adjacent_mines() == 8)
-        {
-            set.add_sprite(eight_cell_,
-                           board_to_screen(p.first),
-                           1);
-        }
-
-        // Draw the reset button depending on game state.
-        if (! model_.is_game_over())
-        {
-            set.add_sprite(default_smiley_,
-                           get_reset_button_position(),
-                           1);
-        }
-        else if (model_.did_user_win())
-        {
-            set.add_sprite(win_smiley_,
-                           get_reset_button_position(),
-                           1);
-        }
-        else if (! model_.did_user_win())
-        {
-            set.add_sprite(lose_smiley_,
-                           get_reset_button_position(),
-                           1);
-        }
-        // Generate and draw the Flag Counter text sprite.
-        ge211::Text_sprite::Builder flag_builder(dseg40);
-        flag_builder << model_.get_flag_counter();
-        flag_counter_.reconfigure(flag_builder);
-        set.add_sprite(flag_counter_, get_flag_counter_position(), 3);
-        // Generate and draw the Time Counter text sprite.
-        ge211::Text_sprite::Builder time_builder(dseg40);
-        time_builder << model_.get_minutes() << ":" << model_.get_seconds();
-        time_counter.reconfigure(time_builder);
-        set.add_sprite(time_counter, get_time_counter_position(), 3);
+        flag_counter_.set_text(std::to_string(flags));
+        shown_flags_ = flags;
+        text_renders_++;
     }
+
+    int seconds = 60 * model_.get_minutes() + model_.get_seconds();
+    if (seconds != shown_seconds_)
+    {
+        time_counter.set_text(std::to_string(model_.get_minutes()) + ":" +
+                              std::to_string(model_.get_seconds()));
+        shown_seconds_ = seconds;
+        text_renders_++;
+    }
+}
+
+
+long
+View::text_renders() const
+{
+    return text_renders_;
+}
+
+
+ge211::Sprite const&
+View::tile_sprite(Tile_tracker::Tile tile) const
+{
+    return tile_atlas_[size_t(tile)];
+}
+
+
+bool
+View::is_in_board_area(View::Position physical) const
+{
+    Dimensions area = viewport_.screen_dimensions();
+    return physical.x >= 2 && physical.x < 2 + area.width &&
+           physical.y >= 2 && physical.y < 2 + area.height;
+}
+
+
+void
+View::scroll_by(Dimensions pixels)
+{
+    Viewport::Position before = viewport_.scroll();
+    viewport_.scroll_by(pixels);
+    viewport_moved_ = viewport_moved_ || viewport_.scroll() != before;
+}
+
+
+void
+View::zoom(int steps, View::Position around)
+{
+    Viewport::Position before = viewport_.scroll();
+    int size_before = viewport_.cell_size();
+    viewport_.zoom(steps, {around.x - 2, around.y - 2});
+    viewport_moved_ = viewport_moved_ || viewport_.scroll() != before ||
+                      viewport_.cell_size() != size_before;
 }
 
 
 View::Dimensions
 View::initial_window_dimensions() const
 {
-    return (cell_size * model_.get_board_dimensions()) + Dimensions{0, 80};
+    Dimensions dims = board_area_dimensions(model_) + Dimensions{0, 80};
+    dims.width = std::max(dims.width, min_window_width);
+    return dims;
 }
 
 
 View::Position
 View::board_to_screen(Model::Position logical)
 {
-    return View::Position{2+(logical.x*cell_size),
-                          2+(logical.y*cell_size)};
+    Viewport::Position pixel = viewport_.board_to_screen(logical);
+    return View::Position{2 + pixel.x, 2 + pixel.y};
 }
 
 
 Model::Position
 View::screen_to_board(View::Position physical)
 {
-    return Model::Position{(physical.x-2)/cell_size,
-                           (physical.y-2)/cell_size};
+    return viewport_.screen_to_board({physical.x - 2, physical.y - 2});
 }
 
 
 View::Position
 View::get_reset_button_position()
 {
-    Model::Dimensions board_dims = model_.get_board_dimensions();
     int x = initial_window_dimensions().width/2 - 30;
-    int y = (2 + (board_dims.height)*cell_size) + 10;
+    int y = (2 + viewport_.screen_dimensions().height) + 10;
     return Position{x, y};
 }
 
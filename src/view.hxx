@@ -1,7 +1,10 @@
 #pragma once
 
 #include "model.hxx"
+#include "tile_tracker.hxx"
+#include "viewport.hxx"
 #include <iostream>
+#include <vector>
 
 class View
 {
@@ -16,7 +19,8 @@ public:
     explicit View(Model const& model);
 
     // Displays sprites on the screen. Called every so often by the draw()
-    // function in Controller.
+    // function in Controller, always with the same sprite set, since the
+    // sprites are retained in it.
     void draw(ge211::Sprite_set& set);
 
     // Convert coordinates referring to Positions on the screen or the View
@@ -29,9 +33,22 @@ public:
     // function actually lies on the Board displayed on the View.
     Model::Position screen_to_board(View::Position);
 
+    // Returns whether a position on the screen is in the part of the
+    // window that shows the board.
+    bool is_in_board_area(View::Position) const;
+
+    // Scrolls the board by the given number of pixels.
+    void scroll_by(Dimensions);
+
+    // Zooms the board in by `steps` zoom levels, or out if `steps` is
+    // negative, keeping the cell under the screen position `around` where
+    // it is.
+    void zoom(int steps, View::Position around);
+
     // Generate the initial dimensions of the window. This is called only
     // once by the game engine. It uses the dimensions of the board in model
-    // and a constant cell_size to generate the window dimensions.
+    // and a constant cell_size to generate the window dimensions, but
+    // boards too big to fit are shown a part at a time.
     Dimensions initial_window_dimensions() const;
 
     // Generates the position of the reset button depending on the dimensions
@@ -46,31 +63,63 @@ public:
     // of the window.
     Position get_flag_counter_position();
 
+    // Returns the number of times the text of the counters has been
+    // changed. It's made from glyphs rendered once, up front, so a change
+    // just picks different glyphs.
+    long text_renders() const;
+
 private:
     Model const& model_;
 
     // Background sprite
     ge211::Rectangle_sprite background_;
 
-    // Image sprites for each tile.
-    ge211::Image_sprite covered_cell_ {"covered-cell.png"};
-    ge211::Image_sprite eight_cell_ {"eight-cell.png"};
-    ge211::Image_sprite empty_cell_ {"empty-cell.png"};
-    ge211::Image_sprite five_cell_ {"five-cell.png"};
-    ge211::Image_sprite flagged_cell_ {"flagged-cell.png"};
-    ge211::Image_sprite four_cell_ {"four-cell.png"};
-    ge211::Image_sprite mine_cell_ {"mine-cell.png"};
-    ge211::Image_sprite one_cell_ {"one-cell.png"};
-    ge211::Image_sprite seven_cell_ {"seven-cell.png"};
-    ge211::Image_sprite six_cell_ {"six-cell.png"};
-    ge211::Image_sprite three_cell_ {"three-cell.png"};
-    ge211::Image_sprite two_cell_ {"two-cell.png"};
+    // The images for the tiles, packed into one atlas in the order of
+    // Tile_tracker::Tile, so a board's worth of tiles is drawn in one
+    // batch.
+    ge211::Atlas tile_atlas_;
+
+    // Image sprites for the reset button.
     ge211::Image_sprite default_smiley_ { "default-smiley.png"};
     ge211::Image_sprite win_smiley_ {"win-smiley.png"};
     ge211::Image_sprite lose_smiley_ {"lose-smiley.png"};
 
-    // Text sprites
+    // Text sprites, made from the glyphs of the characters the counters
+    // can show.
     ge211::Font dseg40{"DSEG14ClassicMini-Regular.ttf", 50};
-    ge211::Text_sprite flag_counter_;
-    ge211::Text_sprite time_counter;
+    ge211::Glyph_atlas counter_glyphs_{dseg40, "0123456789:-"};
+    ge211::Glyph_text_sprite flag_counter_{counter_glyphs_};
+    ge211::Glyph_text_sprite time_counter{counter_glyphs_};
+
+    // The values the counters show, so that their text is only changed
+    // when they change, which is about once a second.
+    int shown_flags_;
+    int shown_seconds_;
+    long text_renders_;
+
+    // Changes the text of the counters if their values changed.
+    void update_counters();
+
+    // Which part of the board the window shows, and at what size. When it
+    // moves, every cell it shows has to be drawn again.
+    Viewport viewport_;
+    bool viewport_moved_;
+
+    // A picture of the part of the board the window shows, which is kept
+    // from frame to frame. Each frame only the cells whose tiles changed
+    // are drawn onto it again, which the tile tracker works out from the
+    // board's change journal.
+    ge211::Canvas_sprite board_canvas_;
+    Tile_tracker tiles_;
+    std::vector<Tile_tracker::Update> tile_updates_;
+
+    // The sprites retained in the sprite set by the first draw.
+    ge211::Sprite_set::Handle background_handle_;
+    ge211::Sprite_set::Handle board_handle_;
+    ge211::Sprite_set::Handle reset_button_handle_;
+    ge211::Sprite_set::Handle flag_counter_handle_;
+    ge211::Sprite_set::Handle time_counter_handle_;
+
+    // Returns the sprite for a tile.
+    ge211::Sprite const& tile_sprite(Tile_tracker::Tile) const;
 };
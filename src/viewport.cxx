@@ -0,0 +1,136 @@
+#include "viewport.hxx"
+
+#include <algorithm>
+#include <cstdlib>
+
+// The cell sizes that zooming steps through, smallest first. Tiles are
+// drawn scaled from 32-pixel images, and below 4 pixels nothing on them
+// can be made out.
+static int const zoom_levels[] = {4, 6, 8, 12, 16, 24, 32, 48, 64};
+static int const zoom_level_count =
+        int(sizeof zoom_levels / sizeof zoom_levels[0]);
+
+// Divides, rounding towards negative infinity, so that pixels left of or
+// above the board map to cells left of or above it.
+static int
+floor_div(int a, int b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+Viewport::Viewport(Dimensions board, Dimensions screen, int cell_size)
+        : board_(board),
+          screen_(screen),
+          zoom_level_(0),
+          scroll_{0, 0}
+{
+    for (int level = 1; level < zoom_level_count; level++)
+    {
+        if (std::abs(zoom_levels[level] - cell_size) <
+            std::abs(zoom_levels[zoom_level_] - cell_size))
+        {
+            zoom_level_ = level;
+        }
+    }
+}
+
+
+Viewport::Dimensions
+Viewport::board_dimensions() const
+{
+    return board_;
+}
+
+
+Viewport::Dimensions
+Viewport::screen_dimensions() const
+{
+    return screen_;
+}
+
+
+int
+Viewport::cell_size() const
+{
+    return zoom_levels[zoom_level_];
+}
+
+
+Viewport::Position
+Viewport::scroll() const
+{
+    return scroll_;
+}
+
+
+Viewport::Rectangle
+Viewport::visible_cells() const
+{
+    int size = cell_size();
+    int left = scroll_.x / size;
+    int top = scroll_.y / size;
+    int right = std::min(board_.width,
+                         (scroll_.x + screen_.width + size - 1) / size);
+    int bottom = std::min(board_.height,
+                          (scroll_.y + screen_.height + size - 1) / size);
+    return {left, top, std::max(right - left, 0), std::max(bottom - top, 0)};
+}
+
+
+Viewport::Position
+Viewport::board_to_screen(Position cell) const
+{
+    return {cell.x * cell_size() - scroll_.x,
+            cell.y * cell_size() - scroll_.y};
+}
+
+
+Viewport::Position
+Viewport::screen_to_board(Position pixel) const
+{
+    return {floor_div(pixel.x + scroll_.x, cell_size()),
+            floor_div(pixel.y + scroll_.y, cell_size())};
+}
+
+
+void
+Viewport::scroll_by(Dimensions pixels)
+{
+    scroll_.x += pixels.width;
+    scroll_.y += pixels.height;
+    clamp_scroll();
+}
+
+
+void
+Viewport::zoom(int steps, Position around)
+{
+    int old_size = cell_size();
+    zoom_level_ = std::max(0, std::min(zoom_level_count - 1,
+                                       zoom_level_ + steps));
+
+    // Scale the distance from the board's corner to the point `around`.
+    int new_size = cell_size();
+    long x = long(scroll_.x + around.x) * new_size / old_size;
+    long y = long(scroll_.y + around.y) * new_size / old_size;
+    scroll_ = {int(x) - around.x, int(y) - around.y};
+    clamp_scroll();
+}
+
+
+void
+Viewport::resize(Dimensions screen)
+{
+    screen_ = screen;
+    clamp_scroll();
+}
+
+
+void
+Viewport::clamp_scroll()
+{
+    int max_x = std::max(0, board_.width * cell_size() - screen_.width);
+    int max_y = std::max(0, board_.height * cell_size() - screen_.height);
+    scroll_.x = std::max(0, std::min(scroll_.x, max_x));
+    scroll_.y = std::max(0, std::min(scroll_.y, max_y));
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "board.hxx"
+
+#include <ge211.hxx>
+
+// Which part of a board a window shows, and at what size. The whole board
+// is laid out with square cells cell_size() pixels across, and the screen
+// shows the part of that layout whose top-left corner is scroll() pixels
+// from the board's top-left corner. Only the cells that can be seen need
+// drawing, so the cost of drawing depends on the size of the screen, not
+// the size of the board.
+class Viewport
+{
+public:
+    // Viewport dimensions will use `int` coordinates, as board dimensions
+    // do.
+    using Dimensions = Board::Dimensions;
+
+    // Viewport positions will use `int` coordinates, as board positions
+    // do.
+    using Position = Board::Position;
+
+    // A rectangle of cells.
+    using Rectangle = ge211::Rect<int>;
+
+    // Makes a viewport onto a board with the given dimensions, for a screen
+    // with the given dimensions in pixels, scrolled to the top-left corner.
+    // `cell_size` is rounded to the nearest zoom level.
+    Viewport(Dimensions board, Dimensions screen, int cell_size);
+
+    // Returns the dimensions of the board, in cells.
+    Dimensions board_dimensions() const;
+
+    // Returns the dimensions of the screen, in pixels.
+    Dimensions screen_dimensions() const;
+
+    // Returns the number of pixels across each cell.
+    int cell_size() const;
+
+    // Returns how far the screen is scrolled from the top-left corner of
+    // the board, in pixels.
+    Position scroll() const;
+
+    // Returns the cells that can be seen, at least in part. It's empty if
+    // the screen is.
+    Rectangle visible_cells() const;
+
+    // Returns the pixel of the screen where the top-left corner of a cell
+    // is. It may be off the screen.
+    Position board_to_screen(Position cell) const;
+
+    // Returns the cell at a pixel of the screen. It may be off the board.
+    Position screen_to_board(Position pixel) const;
+
+    // Scrolls by the given number of pixels, but no further than the edges
+    // of the board.
+    void scroll_by(Dimensions pixels);
+
+    // Zooms in by `steps` zoom levels, or out if it's negative, keeping
+    // the point of the board at the screen pixel `around` where it is, as
+    // far as the edges of the board allow.
+    void zoom(int steps, Position around);
+
+    // Changes the dimensions of the screen, keeping the scroll as it is, as
+    // far as the edges of the board allow.
+    void resize(Dimensions screen);
+
+private:
+    Dimensions board_;
+    Dimensions screen_;
+
+    // The cell size is zoom_levels[zoom_level_].
+    int zoom_level_;
+    Position scroll_;
+
+    // Keeps scroll_ between the top-left corner of the board and the
+    // point where the bottom-right corner of the board meets that of the
+    // screen.
+    void clamp_scroll();
+};
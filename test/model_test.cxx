@@ -1,6 +1,22 @@
+#include "frame_profiler.hxx"
+#include "mine_placement.hxx"
 #include "model.hxx"
+#include "no_guess.hxx"
+#include "probability.hxx"
+#include "simulation.hxx"
+#include "solver.hxx"
+#include "tile_tracker.hxx"
+#include "viewport.hxx"
 #include <catch.hxx>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
 
 
 ///
@@ -14,8 +30,8 @@ struct Test_access
     // Constructs a `Test_access` with a reference to the Model under test.
     explicit Test_access(Model&);
 
-    // Gets the unordered map in Board.
-    std::unordered_map<Model::Position, Cell> get_board();
+    // Gets a view of the cells in Board.
+    Model::Cell_view get_board();
 
     // Gets the dimensions of the board.
     Model::Dimensions get_dimensions();
@@ -36,7 +52,7 @@ Test_access::Test_access(Model& model)
 { }
 
 
-std::unordered_map<Model::Position, Cell>
+Model::Cell_view
 Test_access::get_board()
 {
     return model.get_board();
@@ -67,6 +83,64 @@ Test_access::guarantee_adjacent_mines()
     model.guarantee_adjacent_mines();
 }
 
+///
+/// Allocation counter
+///
+
+// The number of heap allocations made by the whole test program so far.
+// Every call to operator new (and so every container allocation) bumps it,
+// which lets a test check that a piece of code allocates nothing. Every
+// form of new and delete is replaced, so that they all agree on malloc and
+// free.
+static size_t allocation_count = 0;
+
+static void*
+counted_malloc(std::size_t size)
+{
+    ++allocation_count;
+    if (void* result = std::malloc(size ? size : 1))
+    {
+        return result;
+    }
+    throw std::bad_alloc();
+}
+
+void*
+operator new(std::size_t size)
+{
+    return counted_malloc(size);
+}
+
+void*
+operator new[](std::size_t size)
+{
+    return counted_malloc(size);
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
 ///
 /// Test cases
 ///
@@ -82,11 +156,11 @@ TEST_CASE("Test there are 49 mines randomly scattered across the board.")
 {
     Model m;
     Test_access access(m);
-    std::unordered_map<Model::Position, Cell> board = access.get_board();
+    Model::Cell_view board = access.get_board();
 
     // Test that there are 49 mines.
     int counter = 0;
-    for (auto& pos: board)
+    for (auto pos: board)
     {
         if (pos.second.is_mine())
         {
@@ -106,8 +180,8 @@ TEST_CASE("Test there are 49 mines randomly scattered across the board.")
     bool track = false;
 
     // Boards
-    std::unordered_map<Model::Position, Cell> board1 = access.get_board();
-    std::unordered_map<Model::Position, Cell> board2 = access2.get_board();
+    Model::Cell_view board1 = access.get_board();
+    Model::Cell_view board2 = access2.get_board();
 
     for (int w = 0; w < access.get_dimensions().width; w++)
     {
@@ -282,7 +356,7 @@ TEST_CASE("Flag Mechanics")
     m.flag(Model::Position{50, 50});
     CHECK(m.get_flag_counter() == 46);
     // Check the invalid position is not on the board.
-    std::unordered_map<Model::Position, Cell> board = access.get_board();
+    Model::Cell_view board = access.get_board();
     bool counter = false;
     for (auto p: board)
     {
@@ -448,6 +522,69 @@ TEST_CASE("Test Cell")
     CHECK(c.is_mine());
 }
 
+// Check that packing a Cell into one byte keeps its fields independent.
+TEST_CASE("Packed Cell fields")
+{
+    CHECK(sizeof(Cell) == 1);
+
+    Cell c;
+    CHECK(c.is_covered());
+    CHECK(! c.is_flagged());
+    CHECK(! c.is_mine());
+    CHECK(c.get_adjacent_mines() == 0);
+
+    for (size_t num = 0; num <= 8; num++)
+    {
+        c.set_adjacent_mines(num);
+        CHECK(c.get_adjacent_mines() == num);
+    }
+    c.set_flag(true);
+    c.set_mine(true);
+    CHECK(c.is_covered());
+    CHECK(c.is_flagged());
+    CHECK(c.is_mine());
+    CHECK(c.get_adjacent_mines() == 8);
+
+    // Uncovering removes the flag, and nothing else.
+    c.uncover();
+    CHECK(! c.is_covered());
+    CHECK(! c.is_flagged());
+    CHECK(c.is_mine());
+    CHECK(c.get_adjacent_mines() == 8);
+
+    c.set_mine(false);
+    c.set_adjacent_mines(3);
+    CHECK(! c.is_mine());
+    CHECK(c.get_adjacent_mines() == 3);
+    CHECK(! c.is_covered());
+}
+
+// Report how much memory boards of the standard sizes use. A 4096x4096
+// board should take about one byte per cell.
+TEST_CASE("Board memory footprint")
+{
+    std::cout << "Board memory footprint:\n";
+    for (Board::Dimensions dims : {Board::Dimensions{9, 9},
+                                   Board::Dimensions{16, 16},
+                                   Board::Dimensions{30, 16},
+                                   Board::Dimensions{1024, 1024},
+                                   Board::Dimensions{4096, 4096}})
+    {
+        Board board(dims);
+        size_t cells = size_t(dims.width) * dims.height;
+        size_t bytes = board.memory_footprint();
+        std::cout << "  " << dims.width << "x" << dims.height << ": "
+                  << bytes << " bytes ("
+                  << double(bytes) / cells << " per cell)\n";
+
+        CHECK(bytes >= cells);
+        // The bitboard adds a bit per cell, and the padding and the
+        // bookkeeping add a little more.
+        CHECK(bytes <= cells + cells / 8 +
+                       8 * (dims.width + dims.height + 2) * 8 + 512);
+    }
+}
+
 TEST_CASE("Test Model")
 {
     Model model_;
@@ -483,7 +620,7 @@ TEST_CASE("Reveal a cell with the only mine on the board, and lose the game.")
     CHECK(m.did_user_win() == false);
     // Check the un-flagged cells.
     // Get the board.
-    std::unordered_map<Model::Position, Cell> board = m.get_board();
+    Model::Cell_view board = m.get_board();
     // Check that the only covered cells are the ones flagged.
     std::vector<Model::Position> vec;
     for (auto p : board)
@@ -517,7 +654,7 @@ TEST_CASE("Reveal a mine on the edge")
     CHECK(m.is_game_over());
     CHECK(! m.did_user_win());
     // Get the board.
-    std::unordered_map<Model::Position, Cell> board = m.get_board();
+    Model::Cell_view board = m.get_board();
     std::vector<Model::Position> vec;
     for (auto p : board)
     {
@@ -546,7 +683,7 @@ TEST_CASE("Reveal a mine on the corner")
     CHECK(m.is_game_over());
     CHECK(! m.did_user_win());
     // Get the board.
-    std::unordered_map<Model::Position, Cell> board = m.get_board();
+    Model::Cell_view board = m.get_board();
     std::vector<Model::Position> vec;
     for (auto p : board)
     {
@@ -568,7 +705,7 @@ TEST_CASE("Reveal an invalid position")
 
     m.reveal(Model::Position{10000, 10000});
 
-    std::unordered_map<Model::Position, Cell> board = m.get_board();
+    Model::Cell_view board = m.get_board();
     bool present = false;
     for (auto p : board)
     {
@@ -602,7 +739,7 @@ TEST_CASE("Test revealing a cell adjacent to a mine.")
     // Create a vector storing the Positions of the Cells that are uncovered.
     std::vector<Model::Position> vec;
     // Get the board.
-    std::unordered_map<Model::Position, Cell> board = m.get_board();
+    Model::Cell_view board = m.get_board();
     // Cycle through the board
     for (auto p : board)
     {
@@ -636,7 +773,7 @@ TEST_CASE("One mine adjacent")
     // Create a vector storing the Positions of the Cells that are uncovered.
     std::vector<Model::Position> vec;
     // Get the board.
-    std::unordered_map<Model::Position, Cell> board = m.get_board();
+    Model::Cell_view board = m.get_board();
     // Cycle through the board
     for (auto p : board)
     {
@@ -679,7 +816,7 @@ TEST_CASE("Check 8 mines adjacent")
     // Create a vector storing the Positions of the Cells that are uncovered.
     std::vector<Model::Position> vec;
     // Get the board.
-    std::unordered_map<Model::Position, Cell> board = m.get_board();
+    Model::Cell_view board = m.get_board();
     // Cycle through the board
     for (auto p : board)
     {
@@ -714,7 +851,7 @@ TEST_CASE("Revealing a cell on the edge, or in a corner produces no errors.")
     // Create a vector storing the Positions of the Cells that are uncovered.
     std::vector<Model::Position> vec;
     // Get the board.
-    std::unordered_map<Model::Position, Cell> board = m.get_board();
+    Model::Cell_view board = m.get_board();
     // Cycle through the board
     for (auto p : board)
     {
@@ -777,7 +914,7 @@ TEST_CASE("First recursive reveal test")
     // Create a vector storing the Positions of the Cells that are uncovered.
     std::vector<Model::Position> vec;
     // Get the board.
-    std::unordered_map<Model::Position, Cell> board = m.get_board();
+    Model::Cell_view board = m.get_board();
     // Cycle through the board
     for (auto p : board)
     {
@@ -822,7 +959,7 @@ TEST_CASE("Recursive reveal with two mines on the board")
     // Create a vector storing the Positions of the Cells that are covered.
     std::vector<Model::Position> vec;
     // Get the board.
-    std::unordered_map<Model::Position, Cell> board = m.get_board();
+    Model::Cell_view board = m.get_board();
     // Cycle through the board
     for (auto p : board)
     {
@@ -857,7 +994,7 @@ TEST_CASE("Reveal a flagged cell")
     m.reveal(Model::Position{0,0});
 
     // CHECK the flagged cell is not revealed.
-    std::unordered_map<Model::Position, Cell> board = access.get_board();
+    Model::Cell_view board = access.get_board();
     CHECK(board[Model::Position{0,0}].is_covered());
 }
 // Try to reveal an uncovered cell.
@@ -877,7 +1014,7 @@ TEST_CASE("Reveal an uncovered cell")
     m.reveal(Model::Position{8,8});
 
     // CHECK
-    std::unordered_map<Model::Position, Cell> board = access.get_board();
+    Model::Cell_view board = access.get_board();
     CHECK(! board[Model::Position{8,8}].is_mine());
     CHECK(board[Model::Position{8,8}].get_adjacent_mines() == 0);
     CHECK(! board[Model::Position{8,8}].is_covered());
@@ -898,7 +1035,7 @@ TEST_CASE("Flag, and un-flag a cell. Flag a revealed cell.")
 
     m.flag(Model::Position{0,0});
     // Check that it's actually flagged
-    std::unordered_map<Model::Position, Cell> board = access.get_board();
+    Model::Cell_view board = access.get_board();
     CHECK(board[Model::Position{0,0}].is_flagged());
 
     // Check that it's actually un-flagged
@@ -938,7 +1075,7 @@ TEST_CASE("Reset button")
     Test_access access2(m);
     access2.clear_mines_on_board();
 
-    std::unordered_map<Model::Position, Cell> board = access2.get_board();
+    Model::Cell_view board = access2.get_board();
 
     // Test that {0,0} is covered.
     CHECK(board[Model::Position{0,0}].is_covered());
@@ -965,7 +1102,7 @@ TEST_CASE("Test that when c > 100, the flag counter is negative")
     // Now, place 50 flags on unique positions on the board without any rhyme
     // or reason.
     int counter = 0;
-    for (auto& p: access.get_board())
+    for (auto p: access.get_board())
     {
         if (counter < 50)
         {
@@ -1006,5 +1143,1307 @@ TEST_CASE("Win the game")
     CHECK(m.did_user_win());
 }
 
+// Test that viewing the board does not allocate. View::draw walks the whole
+// board through Model::get_board() every frame, so a steady-state frame
+// should make no heap allocations for the board.
+TEST_CASE("Viewing the board every frame makes no heap allocations")
+{
+    Model m;
+    m.flag(Model::Position{3, 4});
+    m.flag(Model::Position{29, 15});
+
+    size_t before = allocation_count;
+    int covered = 0;
+    int flagged = 0;
+    // Simulate one second of frames.
+    for (int frame = 0; frame < 60; frame++)
+    {
+        for (auto p : m.get_board())
+        {
+            if (p.second.is_covered())
+            {
+                covered++;
+            }
+            if (p.second.is_flagged())
+            {
+                flagged++;
+            }
+        }
+    }
+    size_t allocations = allocation_count - before;
+
+    CHECK(allocations == 0);
+    CHECK(covered == 60 * 30 * 16);
+    CHECK(flagged == 60 * 2);
+}
+
+// Test that revealing a huge opening works. A recursive reveal overflows the
+// stack long before the whole board is revealed.
+TEST_CASE("Reveal an empty 2000x2000 board with one click")
+{
+    Board board(Board::Dimensions{2000, 2000});
+    board.clear_mines_on_board();
+    board.guarantee_adjacent_mines();
+
+    CHECK(! board.reveal(Board::Position{1000, 1000}));
+    CHECK(board.win());
+}
+
+// Test the flood fill against a simple recursive reveal, on random boards
+// with flags scattered around to block it.
+TEST_CASE("Flood fill reveals the same cells as a recursive reveal")
+{
+    Board::Dimensions dims{60, 40};
+    std::mt19937 gen(211);
+    std::bernoulli_distribution is_mine(0.08);
+    std::bernoulli_distribution is_flagged(0.03);
+
+    for (int trial = 0; trial < 20; trial++)
+    {
+        Board board(dims);
+        board.clear_mines_on_board();
+        for (auto p : board.get_board())
+        {
+            if (is_mine(gen))
+            {
+                board.set_mine(p.first, true);
+            }
+        }
+        board.guarantee_adjacent_mines();
+        for (auto p : board.get_board())
+        {
+            if (is_flagged(gen))
+            {
+                board.flag(p.first);
+            }
+        }
+
+        // Work out which cells a recursive reveal would uncover.
+        Board::Cell_view cells = board.get_board();
+        std::vector<bool> expected(dims.width * dims.height, false);
+        std::function<void(Board::Position)> reveal =
+                [&](Board::Position pos) {
+                    size_t i = pos.y * dims.width + pos.x;
+                    if (! board.good_position(pos) || expected[i] ||
+                        cells[pos].is_flagged())
+                    {
+                        return;
+                    }
+                    expected[i] = true;
+                    if (cells[pos].get_adjacent_mines() == 0)
+                    {
+                        for (int x = -1; x <= 1; x++)
+                        {
+                            for (int y = -1; y <= 1; y++)
+                            {
+                                reveal({pos.x + x, pos.y + y});
+                            }
+                        }
+                    }
+                };
+        Board::Position click{trial % dims.width, (trial * 7) % dims.height};
+        if (cells[click].is_mine())
+        {
+            continue;
+        }
+        reveal(click);
+
+        board.reveal(click);
+        int mismatches = 0;
+        for (auto p : board.get_board())
+        {
+            size_t i = p.first.y * dims.width + p.first.x;
+            if (p.second.is_covered() == expected[i])
+            {
+                mismatches++;
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+// Test that every way of counting adjacent mines gives the same counts, on
+// boards whose widths fall on either side of a 64-cell word.
+TEST_CASE("Bitboard adjacency counts match the scalar counts")
+{
+    std::mt19937 gen(211);
+
+    for (Board::Dimensions dims : {Board::Dimensions{1, 64},
+                                   Board::Dimensions{30, 16},
+                                   Board::Dimensions{63, 5},
+                                   Board::Dimensions{64, 64},
+                                   Board::Dimensions{65, 3},
+                                   Board::Dimensions{257, 130}})
+    {
+        for (double density : {0.0, 0.2, 0.5, 1.0})
+        {
+            std::bernoulli_distribution is_mine(density);
+            Board scalar(dims);
+            scalar.set_adjacency_engine(Board::Adjacency_engine::scalar);
+            scalar.clear_mines_on_board();
+            Board bitboard(dims);
+            bitboard.set_adjacency_engine(Board::Adjacency_engine::bitboard);
+            bitboard.clear_mines_on_board();
+            Mine_bitboard bits(dims);
+
+            for (auto p : scalar.get_board())
+            {
+                bool m = is_mine(gen);
+                scalar.set_mine(p.first, m);
+                bitboard.set_mine(p.first, m);
+                bits.set(p.first, m);
+            }
+            scalar.guarantee_adjacent_mines();
+            bitboard.guarantee_adjacent_mines();
+
+            // Compare the two Boards.
+            int mismatches = 0;
+            Board::Cell_view bitboard_cells = bitboard.get_board();
+            for (auto p : scalar.get_board())
+            {
+                if (p.second.get_adjacent_mines() !=
+                    bitboard_cells[p.first].get_adjacent_mines())
+                {
+                    mismatches++;
+                }
+            }
+            CHECK(mismatches == 0);
+
+            // Compare every kind of instructions this computer supports,
+            // mines included, against the scalar counts.
+            std::vector<Mine_bitboard::Simd> simds{Mine_bitboard::Simd::none};
+            if (Mine_bitboard::best_simd() != Mine_bitboard::Simd::none)
+            {
+                simds.push_back(Mine_bitboard::Simd::sse2);
+            }
+            if (Mine_bitboard::best_simd() == Mine_bitboard::Simd::avx2)
+            {
+                simds.push_back(Mine_bitboard::Simd::avx2);
+            }
+            std::vector<uint8_t> counts(dims.width);
+            Board::Cell_view cells = scalar.get_board();
+            for (Mine_bitboard::Simd simd : simds)
+            {
+                mismatches = 0;
+                for (int y = 0; y < dims.height; y++)
+                {
+                    bits.count_adjacent_row(y, counts.data(), simd);
+                    for (int x = 0; x < dims.width; x++)
+                    {
+                        size_t expected = 0;
+                        for (int dx = -1; dx <= 1; dx++)
+                        {
+                            for (int dy = -1; dy <= 1; dy++)
+                            {
+                                Board::Position n{x + dx, y + dy};
+                                if ((dx || dy) && scalar.good_position(n) &&
+                                    cells[n].is_mine())
+                                {
+                                    expected++;
+                                }
+                            }
+                        }
+                        if (counts[x] != expected)
+                        {
+                            mismatches++;
+                        }
+                    }
+                }
+                CHECK(mismatches == 0);
+            }
+        }
+    }
+}
+
+// Stress test the board's running counts of covered cells and flags with a
+// million random clicks, checking them against a full recount as it goes.
+TEST_CASE("Covered and flag counts survive a million random clicks")
+{
+    Board::Dimensions dims{500, 400};
+    std::mt19937 gen(211);
+    std::uniform_int_distribution<int> random_x(0, dims.width - 1);
+    std::uniform_int_distribution<int> random_y(0, dims.height - 1);
+    std::bernoulli_distribution is_mine(0.2);
+    std::bernoulli_distribution is_flag_click(0.3);
+
+    Board board(dims);
+    board.clear_mines_on_board();
+    for (auto p : board.get_board())
+    {
+        if (is_mine(gen))
+        {
+            board.set_mine(p.first, true);
+        }
+    }
+    board.guarantee_adjacent_mines();
+
+    auto check_counts = [&] {
+        int covered_safe = 0;
+        int flags = 0;
+        for (auto p : board.get_board())
+        {
+            if (p.second.is_covered() && ! p.second.is_mine())
+            {
+                covered_safe++;
+            }
+            if (p.second.is_flagged())
+            {
+                flags++;
+            }
+        }
+        CHECK(board.covered_safe_cells() == covered_safe);
+        CHECK(board.get_flag_count() == flags);
+        CHECK(board.win() == (covered_safe == 0));
+    };
+
+    for (int click = 1; click <= 1000000; click++)
+    {
+        Board::Position pos{random_x(gen), random_y(gen)};
+        if (is_flag_click(gen))
+        {
+            board.flag(pos);
+        }
+        else
+        {
+            // Hitting a mine doesn't change anything on the board.
+            board.reveal(pos);
+        }
+
+        // Moving a mine now and then changes the counts as well.
+        if (click % 10000 == 0)
+        {
+            board.set_mine(pos, ! board.get_board()[pos].is_mine());
+            board.guarantee_adjacent_mines();
+        }
+
+        if (click % 100000 == 0)
+        {
+            check_counts();
+        }
+    }
+
+    // Losing uncovers everything that isn't flagged.
+    board.uncover_all_besides_flagged();
+    check_counts();
+}
+
+TEST_CASE("Every mine placement method picks distinct cells uniformly")
+{
+    Rng random(211);
 
+    for (Placement_method method : {Placement_method::automatic,
+                                    Placement_method::fisher_yates,
+                                    Placement_method::floyd,
+                                    Placement_method::rejection})
+    {
+        // Every count of mines from none to all of them, and then some.
+        for (int mines : {0, 1, 10, 40, 81, 100})
+        {
+            std::vector<int> cells = choose_mine_cells(81, mines, random,
+                                                       method);
+            CHECK(int(cells.size()) == std::min(mines, 81));
+
+            std::vector<bool> seen(81, false);
+            for (int i : cells)
+            {
+                REQUIRE(i >= 0);
+                REQUIRE(i < 81);
+                CHECK(! seen[i]);
+                seen[i] = true;
+            }
+        }
 
+        // Choosing 3 cells of 10 many times should pick each cell about
+        // 30% of the time.
+        std::vector<int> picks(10, 0);
+        int const rounds = 20000;
+        for (int round = 0; round < rounds; round++)
+        {
+            for (int i : choose_mine_cells(10, 3, random, method))
+            {
+                picks[i]++;
+            }
+        }
+        for (int count : picks)
+        {
+            CHECK(count > rounds * 0.27);
+            CHECK(count < rounds * 0.33);
+        }
+    }
+
+    // Boards smaller than the number of mines are full of mines.
+    Board small({5, 5});
+    for (auto p : small.get_board())
+    {
+        CHECK(p.second.is_mine());
+    }
+    CHECK(small.win());
+}
+
+TEST_CASE("Game configs set the board size and number of mines")
+{
+    CHECK(Game_config().dims == Game_config::Dimensions{30, 16});
+    CHECK(Game_config().mines == 49);
+    CHECK(Game_config::with_density({100, 100}, 0.2).mines == 2000);
+    CHECK(Game_config::expert().density() == Catch::Approx(99.0 / 480));
+
+    for (Game_config config : {Game_config::beginner(),
+                               Game_config::intermediate(),
+                               Game_config::expert(),
+                               Game_config({200, 3}, 7)})
+    {
+        Model m(config);
+        Test_access access(m);
+        CHECK(m.get_board_dimensions() == config.dims);
+        CHECK(m.get_flag_counter() == config.mines);
+        CHECK(m.get_config().mines == config.mines);
+
+        int mines = 0;
+        for (auto p : access.get_board())
+        {
+            if (p.second.is_mine())
+            {
+                mines++;
+            }
+        }
+        CHECK(mines == config.mines);
+    }
+
+    // The flag counter counts down from the number of mines.
+    Model m(Game_config::beginner());
+    m.flag({0, 0});
+    CHECK(m.get_flag_counter() == 9);
+
+    // The old constructor keeps the original number of mines.
+    Model wide(40, 20);
+    CHECK(wide.get_board_dimensions() == Model::Dimensions{40, 20});
+    CHECK(wide.get_flag_counter() == 49);
+
+    // Custom sizes are checked rather than wrapped around.
+    Game_config config;
+    CHECK(Game_config::parse({"200", "100", "3000"}, config));
+    CHECK(config.dims == Game_config::Dimensions{200, 100});
+    CHECK(config.mines == 3000);
+    CHECK(Game_config::parse({"46338", "46338", "1"}, config));
+    CHECK(config.cells() == int64_t(46338) * 46338);
+    for (std::vector<char const*> args :
+            {std::vector<char const*>{"46339", "46339", "1"},
+             std::vector<char const*>{"100000", "100000", "5"},
+             std::vector<char const*>{"99999999999", "5", "3"},
+             std::vector<char const*>{"12x", "5", "3"},
+             std::vector<char const*>{"", "5", "3"},
+             std::vector<char const*>{"5", "0", "3"},
+             std::vector<char const*>{"5", "5", "-1"}})
+    {
+        CHECK_FALSE(Game_config::parse(args, config));
+    }
+    CHECK(config.dims == Game_config::Dimensions{46338, 46338});
+    CHECK(Game_config({100000, 100000}, 5).cells() == 10000000000);
+    CHECK_FALSE(Game_config::is_valid_size({100000, 100000}));
+    CHECK(Game_config::is_valid_size({1, 1}));
+}
+
+TEST_CASE("Boards made from the same seed are the same")
+{
+    // The generator's numbers must never change, or saved seeds would give
+    // different boards.
+    Rng rng(0);
+    CHECK(rng() == 0x99EC5F36CB75F2B4);
+    CHECK(rng() == 0xBF6E1F784956452A);
+    CHECK(rng() == 0x1A5F849D4933E6E0);
+
+    // Numbers in a range stay in it.
+    for (int i = 0; i < 10000; i++)
+    {
+        int n = rng(-3, 5);
+        REQUIRE(n >= -3);
+        REQUIRE(n <= 5);
+    }
+
+    auto mines_of = [](Model const& m) {
+        std::vector<bool> mines;
+        for (auto p : m.get_board())
+        {
+            mines.push_back(p.second.is_mine());
+        }
+        return mines;
+    };
+
+    for (Game_config config : {Game_config(),
+                               Game_config::beginner(),
+                               Game_config::with_density({500, 300}, 0.5)})
+    {
+        Rng rng1(12345);
+        Rng rng2(12345);
+        Rng rng3(54321);
+        Model m1(config, rng1);
+        Model m2(config, rng2);
+        Model m3(config, rng3);
+        CHECK(mines_of(m1) == mines_of(m2));
+        CHECK(mines_of(m1) != mines_of(m3));
+
+        // The next boards from the same generators match too.
+        CHECK(mines_of(Model(config, rng1)) == mines_of(Model(config, rng2)));
+    }
+}
+
+TEST_CASE("Latency histogram percentiles")
+{
+    Latency_histogram h;
+    CHECK(h.percentile(50) == 0);
+
+    for (uint64_t ns = 1; ns <= 1000; ns++)
+    {
+        h.record(ns);
+    }
+    CHECK(h.count() == 1000);
+    CHECK(h.max() == 1000);
+    // Buckets are within 1/16 of the times in them.
+    CHECK(h.percentile(50) <= 500);
+    CHECK(h.percentile(50) >= 500 * 15 / 16);
+    CHECK(h.percentile(99) <= 990);
+    CHECK(h.percentile(99) >= 990 * 15 / 16);
+    CHECK(h.percentile(100) <= 1000);
+
+    // Merging is the same as counting everything in one histogram.
+    Latency_histogram more;
+    more.record(1000000);
+    h.merge(more);
+    CHECK(h.count() == 1001);
+    CHECK(h.max() == 1000000);
+    CHECK(h.percentile(100) == 1000000);
+}
+
+TEST_CASE("Simulated games all finish")
+{
+    Rng rng(7);
+
+    // Sweeping a board with no mines wins with the first click.
+    Sweep_click_policy sweep;
+    Sim_stats empty = simulate(Game_config({20, 10}, 0), 10, sweep, rng);
+    CHECK(empty.games == 10);
+    CHECK(empty.wins == 10);
+    CHECK(empty.clicks == 10);
+    CHECK(empty.reveal_ns.count() == 10);
+
+    // Random clicking either wins or hits a mine, and never stalls.
+    Random_click_policy random(8);
+    Sim_stats stats = simulate(Game_config::beginner(), 500, random, rng);
+    CHECK(stats.games == 500);
+    CHECK(stats.stalls == 0);
+    CHECK(stats.wins < stats.games);
+    CHECK(stats.clicks >= stats.games);
+
+    // Sweeping a board with a mine at the far end opens up the rest of it
+    // with the first click.
+    Model m(Game_config({3, 1}, 0), rng);
+    Test_access access(m);
+    access.set_mine({2, 0}, true);
+    access.guarantee_adjacent_mines();
+    Sim_stats one;
+    CHECK(play_game(m, sweep, one));
+    CHECK(one.clicks == 1);
+    CHECK(one.wins == 1);
+}
+
+TEST_CASE("Parallel simulation gives the same results on any thread count")
+{
+    Click_policy_factory make_random = [](uint64_t seed) {
+        return make_click_policy("random", seed);
+    };
+
+    // An odd number of games, so the last chunk is short.
+    Sim_stats one = simulate_parallel(Game_config::beginner(), 1001, 1,
+                                      make_random, 99, 16);
+    CHECK(one.games == 1001);
+    CHECK(one.reveal_ns.count() == one.clicks);
+
+    for (int threads : {2, 3, 8})
+    {
+        Sim_stats many = simulate_parallel(Game_config::beginner(), 1001,
+                                           threads, make_random, 99, 16);
+        CHECK(many.games == one.games);
+        CHECK(many.wins == one.wins);
+        CHECK(many.clicks == one.clicks);
+        CHECK(many.stalls == one.stalls);
+    }
+
+    // A different seed plays different games.
+    Sim_stats other = simulate_parallel(Game_config::beginner(), 1001, 2,
+                                        make_random, 100, 16);
+    CHECK(other.clicks != one.clicks);
+
+    // More threads than games is fine too.
+    CHECK(simulate_parallel(Game_config::beginner(), 3, 8, make_random, 1)
+                  .games == 3);
+}
+
+TEST_CASE("Starting a new game reuses the board")
+{
+    Rng rng1(5);
+    Rng rng2(5);
+    Model reused(Game_config::expert(), rng1);
+    reused.flag({0, 0});
+    reused.reveal({10, 10});
+    reused.new_game(rng1);
+
+    Model fresh(Game_config::expert(), rng2);
+    fresh = Model(Game_config::expert(), rng2);
+
+    CHECK(reused.get_flag_counter() == 99);
+    CHECK(! reused.is_game_over());
+    auto fresh_board = fresh.get_board();
+    for (auto p : reused.get_board())
+    {
+        CHECK(p.second.is_covered());
+        CHECK(! p.second.is_flagged());
+        CHECK(p.second.is_mine() == fresh_board[p.first].is_mine());
+        CHECK(p.second.get_adjacent_mines() ==
+              fresh_board[p.first].get_adjacent_mines());
+    }
+
+    // After the first board, starting over allocates nothing.
+    size_t before = allocation_count;
+    reused.new_game(rng1);
+    CHECK(allocation_count == before);
+}
+
+TEST_CASE("Solver finds a 1-2-1 pattern with the subset rule")
+{
+    // Row 0 is covered, with mines over the 1s of the 1-2-1 in row 1.
+    // Rows 1 and 2 are uncovered.
+    Board board(Game_config({3, 3}, 0));
+    board.set_mine({0, 0}, true);
+    board.set_mine({2, 0}, true);
+    board.guarantee_adjacent_mines();
+    board.reveal({1, 2});
+
+    Solver solver(board.dimensions());
+    solver.observe_all(board.get_board());
+    solver.deduce();
+
+    // Neither 1 alone says which of its two cells has the mine, but
+    // together with the 2 they do.
+    CHECK(solver.is_known_mine({0, 0}));
+    CHECK(solver.is_known_safe({1, 0}));
+    CHECK(solver.is_known_mine({2, 0}));
+    CHECK(solver.frontier_size() == 0);
+}
+
+TEST_CASE("Solver deductions are always right")
+{
+    Rng rng(31);
+    for (int round = 0; round < 50; round++)
+    {
+        Board board(Game_config::with_density({40, 30}, 0.18), rng);
+        Solver solver(board.dimensions());
+        Model::Cell_view view = board.get_board();
+
+        // Click cells until one is a mine, letting the solver see each
+        // reveal and check everything it has deduced so far.
+        for (int click = 0; click < 200; click++)
+        {
+            Board::Position pos{rng(0, 39), rng(0, 29)};
+            if (! view[pos].is_covered() || board.reveal(pos))
+            {
+                continue;
+            }
+            solver.observe(view, pos);
+            solver.deduce();
+
+            Board::Position found{0, 0};
+            while (solver.next_safe(found))
+            {
+                REQUIRE(! view[found].is_mine());
+            }
+            while (solver.next_mine(found))
+            {
+                REQUIRE(view[found].is_mine());
+            }
+        }
+
+        // Seeing the whole board at once gives the same answers about the
+        // cells that are still covered.
+        Solver fresh(board.dimensions());
+        fresh.observe_all(view);
+        fresh.deduce();
+        for (auto p : view)
+        {
+            if (! p.second.is_covered())
+            {
+                continue;
+            }
+            CHECK(fresh.is_known_mine(p.first) ==
+                  solver.is_known_mine(p.first));
+            CHECK(fresh.is_known_safe(p.first) ==
+                  solver.is_known_safe(p.first));
+        }
+    }
+}
+
+TEST_CASE("Solver plays a game to the end by itself")
+{
+    Rng rng(3);
+    Solver_click_policy solver_policy(4);
+    Sim_stats stats;
+    int wins = 0;
+    for (int game = 0; game < 200; game++)
+    {
+        Model m(Game_config::beginner(), rng);
+        if (play_game(m, solver_policy, stats))
+        {
+            wins++;
+            CHECK(m.did_user_win());
+        }
+        CHECK(m.is_game_over());
+    }
+    CHECK(stats.stalls == 0);
+    // Random clicking almost never wins beginner, but the solver wins most
+    // games: it only loses on guesses.
+    CHECK(wins > 100);
+}
+
+TEST_CASE("Mine probabilities match counting every arrangement")
+{
+    Rng rng(17);
+    Probability_engine engine;
+    Probability_grid grid;
+    for (int round = 0; round < 40; round++)
+    {
+        Game_config config({5, 4}, 6);
+        Board board(config, rng);
+        Model::Cell_view view = board.get_board();
+
+        // Uncover a few safe cells, to leave a frontier with some numbers.
+        for (int click = 0; click < 3; click++)
+        {
+            Board::Position pos{rng(0, 4), rng(0, 3)};
+            if (! view[pos].is_mine())
+            {
+                board.reveal(pos);
+            }
+        }
+
+        // Count, for every cell, the arrangements of the mines among the
+        // covered cells that fit the numbers and put a mine there.
+        std::vector<Board::Position> covered;
+        for (auto p : view)
+        {
+            if (p.second.is_covered())
+            {
+                covered.push_back(p.first);
+            }
+        }
+        std::vector<double> with_mine(covered.size(), 0);
+        double fits = 0;
+        for (uint32_t set = 0; set < (1u << covered.size()); set++)
+        {
+            std::vector<int> mines(20, 0);
+            int count = 0;
+            for (size_t k = 0; k < covered.size(); k++)
+            {
+                if ((set >> k) & 1)
+                {
+                    mines[covered[k].y * 5 + covered[k].x] = 1;
+                    count++;
+                }
+            }
+            if (count != config.mines)
+            {
+                continue;
+            }
+            bool fit = true;
+            for (auto p : view)
+            {
+                if (p.second.is_covered())
+                {
+                    continue;
+                }
+                int around = 0;
+                for (int dy = -1; dy <= 1; dy++)
+                {
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        int x = p.first.x + dx;
+                        int y = p.first.y + dy;
+                        if (x >= 0 && x < 5 && y >= 0 && y < 4)
+                        {
+                            around += mines[y * 5 + x];
+                        }
+                    }
+                }
+                fit = fit && around == int(p.second.get_adjacent_mines());
+            }
+            if (fit)
+            {
+                fits++;
+                for (size_t k = 0; k < covered.size(); k++)
+                {
+                    with_mine[k] += (set >> k) & 1;
+                }
+            }
+        }
+
+        REQUIRE(fits > 0);
+        REQUIRE(engine.compute(view, config.mines, grid));
+        double total = 0;
+        for (size_t k = 0; k < covered.size(); k++)
+        {
+            CHECK(grid[covered[k]] ==
+                  Catch::Approx(with_mine[k] / fits).margin(1e-9));
+            total += grid[covered[k]];
+        }
+        // The chances add up to the number of mines.
+        CHECK(total == Catch::Approx(config.mines));
+    }
+}
+
+TEST_CASE("Mine probabilities agree with the Solver")
+{
+    Rng rng(23);
+    Probability_engine engine(4);
+    Probability_grid grid;
+    for (int round = 0; round < 20; round++)
+    {
+        Game_config config = Game_config::expert();
+        Board board(config, rng);
+        Model::Cell_view view = board.get_board();
+        for (auto p : view)
+        {
+            if (! p.second.is_mine() && p.second.get_adjacent_mines() == 0 &&
+                rng(0, 3) == 0)
+            {
+                board.reveal(p.first);
+            }
+        }
+
+        Solver solver(board.dimensions());
+        solver.observe_all(view);
+        solver.deduce();
+        REQUIRE(engine.compute(view, config.mines, grid));
+
+        double total = 0;
+        for (auto p : view)
+        {
+            if (! p.second.is_covered())
+            {
+                CHECK(grid[p.first] == 0);
+                continue;
+            }
+            total += grid[p.first];
+            if (solver.is_known_mine(p.first))
+            {
+                CHECK(grid[p.first] == Catch::Approx(1));
+            }
+            if (solver.is_known_safe(p.first))
+            {
+                CHECK(grid[p.first] == Catch::Approx(0).margin(1e-9));
+            }
+            if (p.second.is_mine())
+            {
+                CHECK(grid[p.first] > 0);
+            }
+        }
+        CHECK(total == Catch::Approx(config.mines));
+    }
+}
+
+TEST_CASE("A first click opens up an area")
+{
+    Rng rng(41);
+    for (int round = 0; round < 200; round++)
+    {
+        Board::Position first{rng(0, 29), rng(0, 15)};
+        Board board(Game_config::expert(), rng, first);
+        Model::Cell_view view = board.get_board();
+        int mines = 0;
+        for (auto p : view)
+        {
+            mines += p.second.is_mine();
+        }
+        CHECK(mines == 99);
+        CHECK(! view[first].is_mine());
+        CHECK(view[first].get_adjacent_mines() == 0);
+    }
+
+    // When the mines don't fit anywhere else, they still all get placed.
+    Board full(Game_config({3, 3}, 8), rng, {1, 1});
+    CHECK(full.covered_safe_cells() == 1);
+}
+
+TEST_CASE("No-guess boards can be solved from the first click")
+{
+    Game_config config = Game_config::expert();
+    No_guess_generator one(1);
+    No_guess_generator several(4);
+    Solver solver(config.dims);
+    for (uint64_t seed = 0; seed < 20; seed++)
+    {
+        Board::Position first{int(seed) % 30, int(seed) % 16};
+        int64_t found = one.find(config, first, seed);
+        REQUIRE(found >= 0);
+        CHECK(one.candidates_checked() == found + 1);
+        CHECK(several.find(config, first, seed) == found);
+
+        Rng layout = Rng::stream(seed, uint64_t(found));
+        Board board(config, layout, first);
+        CHECK(solve_without_guessing(board, first, solver));
+    }
+}
+
+TEST_CASE("No-guess games are laid out on the first click")
+{
+    Game_config config = Game_config::intermediate();
+    config.no_guess = true;
+
+    Rng rng1(5);
+    Rng rng2(5);
+    Model m1(config, rng1);
+    Model m2(config, rng2);
+    m1.reveal({3, 4});
+    m2.reveal({3, 4});
+    CHECK(! m1.is_game_over());
+    CHECK(m1.get_board()[{3, 4}].get_adjacent_mines() == 0);
+    for (auto p : m1.get_board())
+    {
+        CHECK(p.second.is_mine() == m2.get_board()[p.first].is_mine());
+    }
+
+    // The solver never has to guess after its first click, so it wins
+    // every game.
+    Rng rng(6);
+    Solver_click_policy solver_policy(7);
+    Sim_stats stats;
+    Model m(config, rng);
+    for (int game = 0; game < 50; game++)
+    {
+        m.new_game(rng);
+        CHECK(play_game(m, solver_policy, stats));
+        CHECK(solver_policy.guesses() == 1);
+        CHECK(! m.may_need_guessing());
+    }
+
+    // Clicks off the board or on a flag don't lay it out, so it's still
+    // laid out around the first click that reveals something.
+    for (int game = 0; game < 20; game++)
+    {
+        m.new_game(rng);
+        m.reveal({-1, -1});
+        m.flag({0, 0});
+        m.reveal({0, 0});
+        m.flag({0, 0});
+        CHECK(play_game(m, solver_policy, stats));
+        CHECK(solver_policy.guesses() == 1);
+    }
+
+    // When there are too many mines for a layout that needs no guessing,
+    // the model says so.
+    Game_config dense_config({30, 16}, 130);
+    dense_config.no_guess = true;
+    Model crowded(dense_config, rng);
+    crowded.reveal({15, 8});
+    CHECK(crowded.may_need_guessing());
+    crowded.new_game(rng);
+    CHECK(! crowded.may_need_guessing());
+}
+
+TEST_CASE("Mines move out of the way of the first click")
+{
+    Rng rng(43);
+    for (int round = 0; round < 300; round++)
+    {
+        // Dense boards, so there's usually something in the way.
+        Board board(Game_config({12, 10}, 60), rng);
+        Board::Position first{rng(0, 11), rng(0, 9)};
+        bool opening = round % 2 == 0;
+        board.move_mines_away(first, opening, rng);
+
+        Model::Cell_view view = board.get_board();
+        CHECK(! view[first].is_mine());
+        if (opening)
+        {
+            CHECK(view[first].get_adjacent_mines() == 0);
+        }
+
+        // The counts kept up as the mines moved.
+        Board recounted(board);
+        recounted.guarantee_adjacent_mines();
+        int mines = 0;
+        for (auto p : view)
+        {
+            mines += p.second.is_mine();
+            CHECK(p.second.get_adjacent_mines() ==
+                  recounted.get_board()[p.first].get_adjacent_mines());
+        }
+        CHECK(mines == 60);
+        CHECK(board.covered_safe_cells() == 120 - 60);
+    }
+
+    // With no room around it, the first click is still safe.
+    Board crowded(Game_config({3, 3}, 8), rng);
+    crowded.move_mines_away({1, 1}, true, rng);
+    CHECK(! crowded.get_board()[{1, 1}].is_mine());
+    CHECK(crowded.get_board()[{1, 1}].get_adjacent_mines() == 8);
+}
+
+TEST_CASE("The first reveal of a game can be made safe")
+{
+    Game_config config({8, 8}, 40);
+    config.first_click = Game_config::First_click::safe;
+    Rng rng(47);
+    Model m(config, rng);
+    for (int game = 0; game < 200; game++)
+    {
+        m.new_game(rng);
+        m.reveal({rng(0, 7), rng(0, 7)});
+        CHECK(! (m.is_game_over() && ! m.did_user_win()));
+        CHECK(m.get_flag_counter() == 40);
+    }
+
+    config.first_click = Game_config::First_click::opening;
+    Model opening(config, rng);
+    for (int game = 0; game < 200; game++)
+    {
+        opening.new_game(rng);
+        Model::Position first{rng(0, 7), rng(0, 7)};
+        opening.reveal(first);
+        CHECK(opening.get_board()[first].get_adjacent_mines() == 0);
+    }
+
+    Game_config::First_click first_click = Game_config::First_click::safe;
+    CHECK(Game_config::parse_first_click("opening", first_click));
+    CHECK(first_click == Game_config::First_click::opening);
+    CHECK(! Game_config::parse_first_click("sometimes", first_click));
+    CHECK(first_click == Game_config::First_click::opening);
+}
+
+TEST_CASE("Clicks that reveal nothing don't use up the first click")
+{
+    Game_config config({8, 8}, 40);
+    config.first_click = Game_config::First_click::opening;
+    Rng rng(59);
+    Model m(config, rng);
+    for (int game = 0; game < 200; game++)
+    {
+        m.new_game(rng);
+
+        // Off the board, as the controller reports clicks on the margins.
+        m.reveal({-1, -1});
+        m.reveal({8, 3});
+
+        // On a flagged cell.
+        Model::Position flagged{rng(0, 7), rng(0, 7)};
+        m.flag(flagged);
+        m.reveal(flagged);
+        CHECK(m.get_board()[flagged].is_flagged());
+        CHECK(m.get_board()[flagged].is_covered());
+        CHECK(! m.is_game_over());
+
+        Model::Position first{rng(0, 7), rng(0, 7)};
+        if (first == flagged)
+        {
+            m.flag(flagged);
+        }
+        m.reveal(first);
+        CHECK(! (m.is_game_over() && ! m.did_user_win()));
+        CHECK(m.get_board()[first].get_adjacent_mines() == 0);
+    }
+}
+
+TEST_CASE("Setting mines keeps the counts right")
+{
+    Rng rng(53);
+    Board board(Game_config({17, 11}, 30), rng);
+    Board bulk(board);
+    for (int edit = 0; edit < 2000; edit++)
+    {
+        Board::Position pos{rng(0, 16), rng(0, 10)};
+        bool mine = rng(0, 2) == 0;
+        board.set_mine(pos, mine);
+
+        bulk.begin_bulk_edit();
+        bulk.set_mine(pos, mine);
+        if (edit % 100 == 0)
+        {
+            bulk.end_bulk_edit();
+            Board recounted(board);
+            recounted.guarantee_adjacent_mines();
+            for (auto p : board.get_board())
+            {
+                REQUIRE(p.second.get_adjacent_mines() ==
+                        recounted.get_board()[p.first].get_adjacent_mines());
+                REQUIRE(p.second.get_adjacent_mines() ==
+                        bulk.get_board()[p.first].get_adjacent_mines());
+            }
+            CHECK(board.covered_safe_cells() == bulk.covered_safe_cells());
+        }
+    }
+
+    // Clearing the board leaves counts that set_mine can keep up from.
+    board.clear_mines_on_board();
+    board.set_mine({0, 0}, true);
+    board.set_mine({16, 10}, true);
+    CHECK(board.get_board()[{1, 1}].get_adjacent_mines() == 1);
+    CHECK(board.get_board()[{15, 9}].get_adjacent_mines() == 1);
+    CHECK(board.get_board()[{8, 5}].get_adjacent_mines() == 0);
+    CHECK(board.covered_safe_cells() == 17 * 11 - 2);
+}
+
+TEST_CASE("Tile updates follow the board's change journal")
+{
+    Rng rng(59);
+    Model model(Game_config({20, 12}, 40), rng);
+    Test_access access(model);
+    Tile_tracker tracker;
+    std::vector<Tile_tracker::Update> updates;
+
+    // A new cursor has to look at everything.
+    Model::Journal_cursor cursor;
+    std::vector<Model::Position> changed;
+    CHECK_FALSE(model.changes_since(cursor, changed));
+    CHECK(model.changes_since(cursor, changed));
+    CHECK(changed.empty());
+
+    // The first update hands out every cell, and the next one nothing.
+    CHECK(tracker.update(model, updates));
+    CHECK(updates.size() == 20 * 12);
+    std::vector<Tile_tracker::Tile> drawn(20 * 12);
+    for (Tile_tracker::Update const& update : updates)
+    {
+        drawn[update.pos.y * 20 + update.pos.x] = update.tile;
+    }
+    CHECK_FALSE(tracker.update(model, updates));
+    CHECK(updates.empty());
+
+    // Flagging hands out just that cell.
+    Model::Position corner{0, 0};
+    model.flag(corner);
+    CHECK(model.changes_since(cursor, changed));
+    CHECK(changed == std::vector<Model::Position>{corner});
+    CHECK_FALSE(tracker.update(model, updates));
+    REQUIRE(updates.size() == 1);
+    CHECK(updates[0].pos == corner);
+    CHECK(updates[0].tile == Tile_tracker::Tile::flagged);
+    drawn[0] = updates[0].tile;
+
+    // Whatever happens, drawing just the updates keeps every tile right.
+    for (int action = 0; action < 300; action++)
+    {
+        Model::Position pos{rng(0, 19), rng(0, 11)};
+        int what = rng(0, 40);
+        if (what == 0)
+        {
+            model.new_game(rng);
+        }
+        else if (what == 1)
+        {
+            access.set_mine(pos, ! model.get_board()[pos].is_mine());
+        }
+        else if (what < 12)
+        {
+            model.flag(pos);
+        }
+        else if (! model.get_board()[pos].is_mine() || what == 12)
+        {
+            model.reveal(pos);
+        }
+
+        tracker.update(model, updates);
+        for (Tile_tracker::Update const& update : updates)
+        {
+            drawn[update.pos.y * 20 + update.pos.x] = update.tile;
+        }
+        for (auto p : model.get_board())
+        {
+            REQUIRE(drawn[p.first.y * 20 + p.first.x] ==
+                    Tile_tracker::tile_of(p.second));
+        }
+    }
+
+    // Forgetting hands out every cell again.
+    tracker.forget();
+    CHECK(tracker.update(model, updates));
+    CHECK(updates.size() == 20 * 12);
+}
+
+TEST_CASE("The frame profiler reports a batch of frames at a time")
+{
+    Frame_profiler profiler(3);
+    Frame_profiler::Report report;
+    for (int batch = 0; batch < 2; batch++)
+    {
+        for (int frame = 1; frame <= 3; frame++)
+        {
+            profiler.start();
+            profiler.count(frame);
+            CHECK(profiler.stop(report) == (frame == 3));
+        }
+        CHECK(report.frames == 3);
+        CHECK(report.events == 1 + 2 + 3);
+        CHECK(report.mean_ms >= 0);
+        CHECK(report.mean_ms <= report.worst_ms);
+    }
+}
+
+TEST_CASE("Frame timing keeps the most recent frames in a ring")
+{
+    using ge211::Duration;
+    using ge211::Frame_phase;
+    using ge211::Frame_record;
+
+    // Frame i starts i tenths of a second in, spends 1 ms on events and
+    // i + 1 ms on drawing, and the even ones have a click i ms before
+    // they're presented.
+    ge211::Frame_timing timing(4);
+    ge211::Time_point origin;
+    for (int i = 0; i < 6; i++)
+    {
+        Frame_record record;
+        record.start = origin + Duration(0.1 * i);
+        record.phases[int(Frame_phase::events)] = Duration(0.001);
+        record.phases[int(Frame_phase::draw)] = Duration(0.001 * (i + 1));
+        if (i % 2 == 0)
+        {
+            record.has_click = true;
+            record.click = record.start;
+            record.click_latency = Duration(0.001 * i);
+        }
+        timing.record_for_testing(record);
+    }
+
+    // Frames 0 and 1 were dropped to make room, and the rest are kept
+    // oldest first.
+    CHECK(timing.capacity() == 4);
+    CHECK(timing.size() == 4);
+    CHECK(timing.frames_recorded() == 6);
+    for (size_t i = 0; i < 4; i++)
+    {
+        CHECK(timing[i].phase(Frame_phase::draw).seconds() ==
+              Catch::Approx(0.001 * (i + 3)));
+    }
+    CHECK_THROWS_AS(timing[4], ge211::Client_logic_error);
+
+    Frame_record mean = timing.recent_mean(2);
+    CHECK(mean.phase(Frame_phase::draw).seconds() == Catch::Approx(0.0055));
+    CHECK(mean.has_click);
+    CHECK(mean.click_latency.seconds() == Catch::Approx(0.004));
+
+    // Asking for more frames than are kept means all of them.
+    mean = timing.recent_mean(100);
+    CHECK(mean.phase(Frame_phase::events).seconds() == Catch::Approx(0.001));
+    CHECK(mean.phase(Frame_phase::draw).seconds() == Catch::Approx(0.0045));
+    CHECK(mean.total().seconds() == Catch::Approx(0.0055));
+    CHECK(mean.click_latency.seconds() == Catch::Approx(0.003));
+
+    std::ostringstream csv;
+    timing.write_csv(csv);
+    std::istringstream csv_lines(csv.str());
+    std::vector<std::string> rows;
+    for (std::string row; std::getline(csv_lines, row); )
+    {
+        rows.push_back(row);
+    }
+    REQUIRE(rows.size() == 5);
+    CHECK(rows[0] == "frame,start_ms,events_ms,on_frame_ms,draw_ms,"
+                     "paint_ms,present_ms,sleep_ms,total_ms,"
+                     "click_latency_ms");
+    CHECK(rows[1] == "2,0.000,1.000,0.000,3.000,0.000,0.000,0.000,"
+                     "4.000,2.000");
+    CHECK(rows[2] == "3,100.000,1.000,0.000,4.000,0.000,0.000,0.000,"
+                     "5.000,");
+    CHECK(rows[4] == "5,300.000,1.000,0.000,6.000,0.000,0.000,0.000,"
+                     "7.000,");
+
+    // The trace has a slice for each phase of each frame, and one for
+    // each click.
+    std::ostringstream trace;
+    timing.write_trace(trace);
+    std::string json = trace.str();
+    long slices = 0;
+    for (size_t at = json.find("\"ph\":\"X\""); at != std::string::npos;
+         at = json.find("\"ph\":\"X\"", at + 1))
+    {
+        slices++;
+    }
+    CHECK(slices == 4 * ge211::frame_phase_count + 2);
+    CHECK(std::count(json.begin(), json.end(), '{') ==
+          std::count(json.begin(), json.end(), '}'));
+    CHECK(std::count(json.begin(), json.end(), '[') ==
+          std::count(json.begin(), json.end(), ']'));
+    CHECK(json.find("\"name\":\"click\",\"ph\":\"X\",\"pid\":1,"
+                    "\"tid\":2,\"ts\":200000.0,\"dur\":4000.0}") !=
+          std::string::npos);
+}
+
+TEST_CASE("The viewport shows just the cells on the screen")
+{
+    Viewport viewport({10000, 10000}, {1280, 768}, 32);
+    CHECK(viewport.cell_size() == 32);
+    CHECK(viewport.visible_cells() == Viewport::Rectangle{0, 0, 40, 24});
+
+    // Part-way into a cell still shows it, and pixels map back to cells.
+    viewport.scroll_by({16, 40});
+    CHECK(viewport.visible_cells() == Viewport::Rectangle{0, 1, 41, 25});
+    CHECK(viewport.board_to_screen({1, 2}) == Viewport::Position{16, 24});
+    CHECK(viewport.screen_to_board({16, 24}) == Viewport::Position{1, 2});
+    CHECK(viewport.screen_to_board({-20, 0}) == Viewport::Position{-1, 1});
+
+    // Scrolling stops at the edges of the board.
+    viewport.scroll_by({-1000, -1000});
+    CHECK(viewport.scroll() == Viewport::Position{0, 0});
+    viewport.scroll_by({1000000000, 1000000000});
+    CHECK(viewport.scroll() ==
+          Viewport::Position{10000 * 32 - 1280, 10000 * 32 - 768});
+    Viewport::Rectangle cells = viewport.visible_cells();
+    CHECK(cells.x + cells.width == 10000);
+    CHECK(cells.y + cells.height == 10000);
+
+    // Zooming keeps the cell under the mouse where it is.
+    Viewport::Position mouse{640, 384};
+    viewport.scroll_by({-100000, -100000});
+    Viewport::Position cell = viewport.screen_to_board(mouse);
+    viewport.zoom(-2, mouse);
+    CHECK(viewport.cell_size() == 16);
+    CHECK(viewport.screen_to_board(mouse) == cell);
+    viewport.zoom(-100, mouse);
+    CHECK(viewport.cell_size() == 4);
+    CHECK(viewport.visible_cells().width == 1280 / 4);
+
+    // A small board zoomed out shows all of it.
+    Viewport small({30, 16}, {960, 512}, 32);
+    small.zoom(-1, {0, 0});
+    CHECK(small.visible_cells() == Viewport::Rectangle{0, 0, 30, 16});
+    small.scroll_by({50, 50});
+    CHECK(small.scroll() == Viewport::Position{0, 0});
+}
+
+TEST_CASE("Tile updates can be limited to the visible cells")
+{
+    Rng rng(61);
+    Model model(Game_config({200, 150}, 3000), rng);
+    Tile_tracker tracker;
+    std::vector<Tile_tracker::Update> updates;
+    Tile_tracker::Rectangle visible{50, 40, 30, 20};
+
+    CHECK(tracker.update(model, visible, updates));
+    CHECK(updates.size() == 30 * 20);
+    for (Tile_tracker::Update const& update : updates)
+    {
+        CHECK(update.pos.x >= 50);
+        CHECK(update.pos.x < 80);
+        CHECK(update.pos.y >= 40);
+        CHECK(update.pos.y < 60);
+    }
+
+    // Changes outside the rectangle aren't handed out.
+    model.flag({0, 0});
+    model.flag({60, 50});
+    CHECK_FALSE(tracker.update(model, visible, updates));
+    REQUIRE(updates.size() == 1);
+    CHECK(updates[0].pos == Model::Position{60, 50});
+
+    // Moving the rectangle hands out all of it again.
+    visible = {51, 40, 30, 20};
+    CHECK(tracker.update(model, visible, updates));
+    CHECK(updates.size() == 30 * 20);
+}